@@ -1,8 +1,9 @@
 const express = require("express");
 const cors = require("cors");
 const colors = require("colors");
-const fs = require("fs").promises;
-const { exec } = require("child_process");
+const net = require("net");
+const os = require("os");
+const { spawn } = require("child_process");
 const path = require("path");
 const dotenv = require("dotenv");
 const collectTests = require("./collectTests"); 
@@ -14,6 +15,176 @@ const port = process.env.PORT || process.env.BLUE_PORT || 10000;
 
 app.use(express.json());
 
+// One interpreter process stays up and forks a child per request, instead of
+// a process started per request. Requests go over a Unix socket as
+// "<type> <length>\n<source>", see src/Server/Server.h for the reply.
+// Programs it has compiled before skip straight to execution.
+const interpreterPath = path.join(__dirname, "main");
+const socketPath = path.join(os.tmpdir(), `blue-interpreter-${process.pid}.sock`);
+
+// Every program is stopped with error 40 once it passes these, so a runaway
+// loop only holds its connection until the time limit
+const timeLimit = Number(process.env.BLUE_TIME_LIMIT_MS) || 5000;
+const limits = [
+  `--time-limit=${timeLimit}`,
+  `--max-memory=${process.env.BLUE_MAX_MEMORY_MB || 256}`,
+];
+if (process.env.BLUE_MAX_STEPS) {
+  limits.push(`--max-steps=${process.env.BLUE_MAX_STEPS}`);
+}
+
+function startInterpreter() {
+  const interpreter = spawn(interpreterPath, [`--serve=${socketPath}`, ...limits], {
+    stdio: ["ignore", "inherit", "inherit"],
+  });
+  interpreter.on("exit", (code, signal) => {
+    console.log(`Interpreter server exited (${signal || code}), restarting`.red);
+    setTimeout(startInterpreter, 1000);
+  });
+}
+
+startInterpreter();
+
+// A request with no reply by then gives up its connection, so an
+// interpreter that hangs can't hold a place in the pool for good
+const requestTimeout =
+  Number(process.env.BLUE_REQUEST_TIMEOUT_MS) || timeLimit + 5000;
+
+// A few connections stay open, each answered by an interpreter process of
+// its own that keeps the programs it compiled, and requests wait for a free
+// one
+const poolSize = Math.min(os.cpus().length, 4);
+const idleConnections = [];
+const waitingRequests = [];
+let openConnections = 0;
+
+class InterpreterConnection {
+  constructor(socket) {
+    this.socket = socket;
+    this.buffer = Buffer.alloc(0);
+    this.pending = null;
+    this.closed = false;
+
+    socket.on("data", (chunk) => {
+      this.buffer = Buffer.concat([this.buffer, chunk]);
+      this.readReply();
+    });
+    socket.on("close", () => {
+      this.closed = true;
+      if (this.pending) {
+        this.pending.reject(new Error("Interpreter closed the connection"));
+        this.pending = null;
+      }
+    });
+    socket.on("error", () => {}); // reported through "close"
+  }
+
+  // Resolves with { status, stdout, stderr }. Past the request timeout the
+  // socket is dropped and the pool opens a new connection in its place.
+  run(type, source) {
+    return new Promise((resolve, reject) => {
+      const timer = setTimeout(() => {
+        this.pending = null;
+        this.closed = true;
+        this.socket.destroy();
+        reject(new Error(`No reply from the interpreter in ${requestTimeout} ms`));
+      }, requestTimeout);
+      this.pending = {
+        resolve: (reply) => {
+          clearTimeout(timer);
+          resolve(reply);
+        },
+        reject: (error) => {
+          clearTimeout(timer);
+          reject(error);
+        },
+      };
+      this.socket.write(`${type} ${source.length}\n`);
+      this.socket.write(source);
+    });
+  }
+
+  readReply() {
+    const headerEnd = this.buffer.indexOf("\n");
+    if (headerEnd < 0 || !this.pending) {
+      return;
+    }
+    const [status, outLength, errLength] = this.buffer
+      .subarray(0, headerEnd)
+      .toString()
+      .split(" ")
+      .map(Number);
+    const outEnd = headerEnd + 1 + outLength;
+    const errEnd = outEnd + errLength;
+    if (this.buffer.length < errEnd) {
+      return;
+    }
+
+    const stdout = this.buffer.subarray(headerEnd + 1, outEnd).toString();
+    const stderr = this.buffer.subarray(outEnd, errEnd).toString();
+    this.buffer = this.buffer.subarray(errEnd);
+    const { resolve } = this.pending;
+    this.pending = null;
+    resolve({ status, stdout, stderr });
+  }
+}
+
+// Retries while the server is still starting
+function connect(retries = 40) {
+  return new Promise((resolve, reject) => {
+    const socket = net.createConnection(socketPath);
+    socket.once("connect", () => resolve(new InterpreterConnection(socket)));
+    socket.once("error", (error) => {
+      const starting = error.code === "ENOENT" || error.code === "ECONNREFUSED";
+      if (!starting || retries === 0) {
+        return reject(error);
+      }
+      setTimeout(() => connect(retries - 1).then(resolve, reject), 50);
+    });
+  });
+}
+
+function acquireConnection() {
+  while (idleConnections.length > 0) {
+    const connection = idleConnections.pop();
+    if (!connection.closed) {
+      return Promise.resolve(connection);
+    }
+    openConnections--;
+  }
+  if (openConnections < poolSize) {
+    openConnections++;
+    return connect().catch((error) => {
+      openConnections--;
+      throw error;
+    });
+  }
+  return new Promise((resolve, reject) =>
+    waitingRequests.push({ resolve, reject })
+  );
+}
+
+function releaseConnection(connection) {
+  if (connection.closed) {
+    openConnections--;
+  } else {
+    idleConnections.push(connection);
+  }
+  const waiting = waitingRequests.shift();
+  if (waiting) {
+    acquireConnection().then(waiting.resolve, waiting.reject);
+  }
+}
+
+async function runOnInterpreter(type, sourceCode) {
+  const connection = await acquireConnection();
+  try {
+    return await connection.run(type, Buffer.from(sourceCode, "utf8"));
+  } finally {
+    releaseConnection(connection);
+  }
+}
+
 app.use(
   cors({
     origin: [
@@ -26,28 +197,30 @@ app.post("/execute-blue-code/:type", async (req, res) => {
   const { sourceCode } = req.body;
   const { type } = req.params;
 
-  const filePath = path.join(__dirname, "tempSourceCode.c"); 
-  const interpreterPath = path.join(__dirname, "main");
-
-  const command = `${interpreterPath} ${filePath} ${type}`;
+  if (!/^[A-Za-z-]+$/.test(type)) {
+    return res.json({
+      isError: true,
+      output: "",
+      stderr: `Unknown option: ${type}`,
+    });
+  }
 
   try {
-    await fs.writeFile(filePath, sourceCode);
-    console.log("Source code written to:", filePath);
-
-    exec(command, (error, stdout, stderr) => {
-      if (error) {
-        return res.json({
-          isError: true,
-          output: "",
-          stderr: `Command failed: ${error.message}\n${stderr}`,
-        });
-      }
+    const { status, stdout, stderr } = await runOnInterpreter(
+      type,
+      sourceCode || ""
+    );
+    if (status !== 0) {
       return res.json({
-        isError: false,
-        output: stdout,
-        stderr: stderr,
+        isError: true,
+        output: "",
+        stderr: `Command failed: exit code ${status}\n${stderr}`,
       });
+    }
+    return res.json({
+      isError: false,
+      output: stdout,
+      stderr: stderr,
     });
   } catch (error) {
     res.json({
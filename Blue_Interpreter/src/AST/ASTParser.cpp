@@ -5,17 +5,17 @@
 
 using namespace std;
 
-ASTParser::ASTParser(const NodePtr &cstRoot)
-    : currCstNode(cstRoot), root(nullptr), lastASTNode(nullptr) {}
+ASTParser::ASTParser(const NodePtr &cstRoot, NodeArena &arena)
+    : arena(arena), root(nullptr), currCstNode(cstRoot), lastASTNode(nullptr) {}
 
 NodePtr ASTParser::parse() {
     while (currCstNode) {
         // Get the string token value stored in the cst node
-        string cstNodeValue = currCstNode->Value().value();
+        const string &cstNodeValue = currCstNode->Value().value();
         // Determine the semantic type and set it while creating root node
         Node::Type type = determineSemanticNodeType(cstNodeValue);
         // Create a new node with the same value and updated "type"
-        auto newNode = make_shared<Node>(currCstNode->Value(), type);
+        auto newNode = arena.create(currCstNode->Value(), type);
 
         // Add as child or sibling based on the type
         if (type != Node::Type::OTHER) {
@@ -37,7 +37,7 @@ NodePtr ASTParser::parse() {
                                                         // it into postfix
 
                 } else if (type == Node::Type::FOR) {
-                    addToAST(make_shared<Node>(currCstNode->Value(),
+                    addToAST(arena.create(currCstNode->Value(),
                                                Node::Type::ForExpression1),
                              LeftChild);
                     parseFor(currCstNode);
@@ -48,7 +48,7 @@ NodePtr ASTParser::parse() {
             if (currCstNode->Right()->Value().value() == "(") {
                 // Create CALL node
                 addToAST(
-                    make_shared<Node>(currCstNode->Value(), Node::Type::CALL),
+                    arena.create(currCstNode->Value(), Node::Type::CALL),
                     LeftChild);
 
                 currCstNode = currCstNode->Right(); // skip (
@@ -56,14 +56,14 @@ NodePtr ASTParser::parse() {
 
                 // Get Params
                 while (currCstNode->Value().type() == Token::Type::Identifier) {
-                    addToAST(make_shared<Node>(currCstNode->Value(),
+                    addToAST(arena.create(currCstNode->Value(),
                                                Node::Type::OTHER),
                              RightSibling);
                     currCstNode = currCstNode->Right(); // skip , or )
                 }
             } else {
                 // Must be an assignment op
-                addToAST(make_shared<Node>(currCstNode->Value(),
+                addToAST(arena.create(currCstNode->Value(),
                                            Node::Type::ASSIGNMENT),
                          LeftChild);
                 parseAssignment(currCstNode);
@@ -86,11 +86,11 @@ NodePtr ASTParser::parseTypeDec(NodePtr &currCstNode) {
     currCstNode = currCstNode->Right();
 
     // add node of first identifier
-    addToAST(make_shared<Node>(currCstNode->Value(),Node::Type::DECLARATION),LeftChild);
+    addToAST(arena.create(currCstNode->Value(),Node::Type::DECLARATION),LeftChild);
 
     while (currCstNode->value.value() != ";") {
         if (currCstNode->value.value() == ",") {
-            addToAST(make_shared<Node>(peekNext(currCstNode)->Value(),
+            addToAST(arena.create(peekNext(currCstNode)->Value(),
                                        Node::Type::DECLARATION),
                      LeftChild);
         }
@@ -103,54 +103,49 @@ NodePtr ASTParser::parseFor(NodePtr &currCstNode) {
     // Store the line of nodes in this subtree as a vector
     // Pass it into the function and then add them all in the AST in that orde
     NodePtr rootSubTreeNode = currCstNode;
-    std::vector<NodePtr> exp1, exp2, exp3;
 
     currCstNode = currCstNode->Right(); // skipping first '('
     currCstNode = currCstNode->Right();
 
     // parse the first expression
+    inFixNodes.clear();
     while (currCstNode->value.value() != ";") {
-        exp1.push_back(currCstNode);
+        inFixNodes.push_back(currCstNode);
         currCstNode = currCstNode->Right();
     }
-    // change first expression to postfix
-    exp1 = inToPostFix(exp1);
-
-    // add first expression
-    for (const auto &node : exp1) {
+    // change first expression to postfix and add it
+    for (const auto &node : inToPostFix(inFixNodes)) {
         addToAST(node, RightSibling);
     }
 
     // parse the second expression
     currCstNode = currCstNode->Right();
+    inFixNodes.clear();
     while (currCstNode->value.value() != ";") {
-        exp2.push_back(currCstNode);
+        inFixNodes.push_back(currCstNode);
         currCstNode = currCstNode->Right();
     }
-    // change second expression to postfix
-    exp2 = inToPostFix(exp2);
 
     // add second expressiont to AST
     addToAST(
-        make_shared<Node>(currCstNode->Value(), Node::Type::ForExpression2),
+        arena.create(currCstNode->Value(), Node::Type::ForExpression2),
         LeftChild);
-    for (const auto &node : exp2) {
+    for (const auto &node : inToPostFix(inFixNodes)) {
         addToAST(node, RightSibling);
     }
 
     // parse the third express
+    inFixNodes.clear();
     while (currCstNode->value.value() != ")") {
-        exp3.push_back(currCstNode);
+        inFixNodes.push_back(currCstNode);
         currCstNode = currCstNode->Right();
     }
 
-    // change the third expression to postfix
-    exp3 = inToPostFix(exp3);
     // add third to ast
     addToAST(
-        make_shared<Node>(currCstNode->Value(), Node::Type::ForExpression3),
+        arena.create(currCstNode->Value(), Node::Type::ForExpression3),
         LeftChild);
-    for (const auto &node : exp3) {
+    for (const auto &node : inToPostFix(inFixNodes)) {
         addToAST(node, RightSibling);
     }
 
@@ -158,13 +153,12 @@ NodePtr ASTParser::parseFor(NodePtr &currCstNode) {
 }
 
 NodePtr ASTParser::parsePrintF(NodePtr &currCstNode) {
-    NodePtr rootSubTreeNode = currCstNode;
     currCstNode = currCstNode->Right(); // skip first '('
 
     while (currCstNode->value.value() != ")") {
         if (currCstNode->value.value() != ",") {
             auto nodeCopy =
-                make_shared<Node>(currCstNode->Value(), Node::Type::OTHER);
+                arena.create(currCstNode->Value(), Node::Type::OTHER);
             addToAST(nodeCopy, RightSibling);
         }
         currCstNode = currCstNode->Right();
@@ -176,19 +170,17 @@ NodePtr ASTParser::parseIFsORWhiles(NodePtr &currCstNode) {
     // Store the line of nodes in this subtree as a vector
     // Pass it into the function and then add them all in the AST in that orde
     NodePtr rootSubTreeNode = currCstNode;
-    std::vector<NodePtr> assignmentNodes;
+    inFixNodes.clear();
 
     while (currCstNode->Right() != nullptr) {
-        assignmentNodes.push_back(currCstNode);
+        inFixNodes.push_back(currCstNode);
         currCstNode = currCstNode->Right();
     }
-    assignmentNodes.push_back(currCstNode); // add the last ')' to vector
-
-    //  Must parse the entire line in postFix notations
-    assignmentNodes = inToPostFix(assignmentNodes);
+    inFixNodes.push_back(currCstNode); // add the last ')' to vector
 
-    // Now for the size of the vector, add to the tree
-    for (const auto &node : assignmentNodes) {
+    //  Must parse the entire line in postFix notations, then add it to the
+    //  tree
+    for (const auto &node : inToPostFix(inFixNodes)) {
         addToAST(node, RightSibling);
     }
     return rootSubTreeNode;
@@ -198,18 +190,16 @@ NodePtr ASTParser::parseAssignment(NodePtr &currCstNode) {
     // Store the line of nodes in this subtree as a vector
     // Pass it into the function and then add them all in the AST in that orde
     NodePtr rootSubTreeNode = currCstNode;
-    std::vector<NodePtr> assignmentNodes;
+    inFixNodes.clear();
 
     while (currCstNode->Value().type() != Token::Type::Semicolon) {
-        assignmentNodes.push_back(currCstNode);
+        inFixNodes.push_back(currCstNode);
         currCstNode = currCstNode->Right();
     }
 
-    //  Must parse the entire line in postFix notations
-    assignmentNodes = inToPostFix(assignmentNodes);
-
-    // Now for the size of the vector, add to the tree
-    for (const auto &node : assignmentNodes) {
+    //  Must parse the entire line in postFix notations, then add it to the
+    //  tree
+    for (const auto &node : inToPostFix(inFixNodes)) {
         addToAST(node, RightSibling);
     }
     return rootSubTreeNode;
@@ -254,15 +244,19 @@ Node::Type ASTParser::determineSemanticNodeType(const std::string &value) {
     return Node::Type::OTHER; // Default type if none of the conditions match
 }
 
-bool ASTParser::isDataType(string id) {
+bool ASTParser::isDataType(const string &id) {
     if (id == "char" || id == "int" || id == "bool")
         return true;
     return false;
 }
 
-std::vector<NodePtr> ASTParser::inToPostFix(const std::vector<NodePtr> &inFix) {
-    vector<NodePtr> stack;
-    vector<NodePtr> postFix;
+// The result stays valid until the next call
+const std::vector<NodePtr> &
+ASTParser::inToPostFix(const std::vector<NodePtr> &inFix) {
+    vector<NodePtr> &stack = operatorStack;
+    vector<NodePtr> &postFix = postFixNodes;
+    stack.clear();
+    postFix.clear();
 
     for (int i = 0; i < inFix.size(); ++i) {
         Token::Type tokType = inFix[i]->Value().type();
@@ -323,7 +317,8 @@ std::vector<NodePtr> ASTParser::inToPostFix(const std::vector<NodePtr> &inFix) {
                         tokType == Token::Type::Minus ||
                         tokType == Token::Type::Asterisk ||
                         tokType == Token::Type::Slash ||
-                        tokType == Token::Type::Modulo) {
+                        tokType == Token::Type::Modulo ||
+                        tokType == Token::Type::Caret) {
                         if (stack.empty()) {
                             stack.push_back(inFix[i]); // put on stack
                         } else {
@@ -354,6 +349,9 @@ std::vector<NodePtr> ASTParser::inToPostFix(const std::vector<NodePtr> &inFix) {
                                             finished = true;
                                         }
                                     }
+                                } else if (tokType == Token::Type::Caret) {
+                                    // binds tightest and groups right to left
+                                    stack.push_back(inFix[i]); // put on stack
                                 } else {
                                     if (tokType == Token::Type::Asterisk ||
                                         tokType == Token::Type::Slash ||
@@ -373,7 +371,10 @@ std::vector<NodePtr> ASTParser::inToPostFix(const std::vector<NodePtr> &inFix) {
                                                         Token::Type::Slash ||
                                                     stack.back()
                                                             ->value.type() ==
-                                                        Token::Type::Modulo) {
+                                                        Token::Type::Modulo ||
+                                                    stack.back()
+                                                            ->value.type() ==
+                                                        Token::Type::Caret) {
                                                     postFix.push_back(
                                                         stack
                                                             .back()); // display
@@ -420,6 +421,11 @@ std::vector<NodePtr> ASTParser::inToPostFix(const std::vector<NodePtr> &inFix) {
                                                                 .type() ==
                                                             Token::Type::
                                                                 Modulo ||
+                                                        stack.back()
+                                                                ->value
+                                                                .type() ==
+                                                            Token::Type::
+                                                                Caret ||
                                                         stack.back()
                                                                 ->value
                                                                 .type() ==
@@ -477,6 +483,11 @@ std::vector<NodePtr> ASTParser::inToPostFix(const std::vector<NodePtr> &inFix) {
                                                                     .type() ==
                                                                 Token::Type::
                                                                     Modulo ||
+                                                            stack.back()
+                                                                    ->value
+                                                                    .type() ==
+                                                                Token::Type::
+                                                                    Caret ||
                                                             stack.back()
                                                                     ->value
                                                                     .type() ==
@@ -572,6 +583,11 @@ std::vector<NodePtr> ASTParser::inToPostFix(const std::vector<NodePtr> &inFix) {
                                                                         .type() ==
                                                                     Token::Type::
                                                                         Modulo ||
+                                                                stack.back()
+                                                                        ->value
+                                                                        .type() ==
+                                                                    Token::Type::
+                                                                        Caret ||
                                                                 stack.back()
                                                                         ->value
                                                                         .type() ==
@@ -2,15 +2,13 @@
 #define ASTPARSER_H
 
 #include "../Node/Node.h"
+#include "../Node/NodeArena.h"
 #include "../Token/Token.h"
-#include <memory>
 #include <vector>
 
-using NodePtr = std::shared_ptr<Node>;
-
 class ASTParser {
   public:
-    explicit ASTParser(const NodePtr &cstRoot);
+    ASTParser(const NodePtr &cstRoot, NodeArena &arena);
 
     enum InsertionMode { LeftChild, RightSibling };
 
@@ -25,14 +23,20 @@ class ASTParser {
     // std::vector<Node> inToPostFix(const std::vector<Node> &infix);
 
   private:
-    NodePtr root;        // Root of the AST
-    NodePtr currCstNode; // Current node in the CST being processed
-    NodePtr lastASTNode; // Last node added to the AST
+    NodeArena &arena;    // owns the nodes of the AST
+    NodePtr root = nullptr;        // Root of the AST
+    NodePtr currCstNode = nullptr; // Current node in the CST being processed
+    NodePtr lastASTNode = nullptr; // Last node added to the AST
 
     // The actual string value of the node
     std::string value;
 
-    bool isDataType(std::string value);
+    // Reused for every expression, so rows don't allocate once they've grown
+    std::vector<NodePtr> inFixNodes;
+    std::vector<NodePtr> postFixNodes;
+    std::vector<NodePtr> operatorStack;
+
+    bool isDataType(const std::string &value);
 
     // maps the semantics identifiers to the type defined in Node class
     Node::Type determineSemanticNodeType(const std::string &value);
@@ -40,7 +44,7 @@ class ASTParser {
     NodePtr parseIFsORWhiles(NodePtr &currCstNode);
     NodePtr parseFor(NodePtr &currCstNode);
     NodePtr parsePrintF(NodePtr &currCstNode);
-    std::vector<NodePtr> inToPostFix(const std::vector<NodePtr> &infix);
+    const std::vector<NodePtr> &inToPostFix(const std::vector<NodePtr> &infix);
     NodePtr parseTypeDec(NodePtr &currCstNode);
     void addToAST(NodePtr node, InsertionMode);
 };
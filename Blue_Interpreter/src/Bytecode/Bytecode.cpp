@@ -0,0 +1,131 @@
+#include "Bytecode.h"
+
+int BytecodeProgram::emit(OpCode op, int a, int b, int line) {
+    Instruction ins;
+    ins.op = op;
+    ins.a = a;
+    ins.b = b;
+    code.push_back(ins);
+    lines.push_back(line);
+    return static_cast<int>(code.size()) - 1;
+}
+
+int BytecodeProgram::addString(const std::string &text) {
+    for (int i = 0; i < strings.size(); ++i) {
+        if (strings[i] == text)
+            return i;
+    }
+    strings.push_back(text);
+    return static_cast<int>(strings.size()) - 1;
+}
+
+std::string BytecodeProgram::opCodeToString(OpCode op) {
+    switch (op) {
+    case OpCode::PUSH:
+        return "PUSH";
+    case OpCode::POP:
+        return "POP";
+    case OpCode::LOAD_GLOBAL:
+        return "LOAD_GLOBAL";
+    case OpCode::STORE_GLOBAL:
+        return "STORE_GLOBAL";
+    case OpCode::LOAD_LOCAL:
+        return "LOAD_LOCAL";
+    case OpCode::STORE_LOCAL:
+        return "STORE_LOCAL";
+    case OpCode::LOAD_GLOBAL_ELEM:
+        return "LOAD_GLOBAL_ELEM";
+    case OpCode::STORE_GLOBAL_ELEM:
+        return "STORE_GLOBAL_ELEM";
+    case OpCode::LOAD_LOCAL_ELEM:
+        return "LOAD_LOCAL_ELEM";
+    case OpCode::STORE_LOCAL_ELEM:
+        return "STORE_LOCAL_ELEM";
+    case OpCode::ADD:
+        return "ADD";
+    case OpCode::SUB:
+        return "SUB";
+    case OpCode::MUL:
+        return "MUL";
+    case OpCode::DIV:
+        return "DIV";
+    case OpCode::MOD:
+        return "MOD";
+    case OpCode::POW:
+        return "POW";
+    case OpCode::AND:
+        return "AND";
+    case OpCode::OR:
+        return "OR";
+    case OpCode::EQ:
+        return "EQ";
+    case OpCode::NE:
+        return "NE";
+    case OpCode::LT:
+        return "LT";
+    case OpCode::GT:
+        return "GT";
+    case OpCode::LE:
+        return "LE";
+    case OpCode::GE:
+        return "GE";
+    case OpCode::NOT:
+        return "NOT";
+    case OpCode::JUMP:
+        return "JUMP";
+    case OpCode::JUMP_IF_FALSE:
+        return "JUMP_IF_FALSE";
+    case OpCode::CALL:
+        return "CALL";
+    case OpCode::RETURN:
+        return "RETURN";
+    case OpCode::PRINT_INT:
+        return "PRINT_INT";
+    case OpCode::PRINT_TEXT:
+        return "PRINT_TEXT";
+    case OpCode::PRINT_STR_GLOBAL:
+        return "PRINT_STR_GLOBAL";
+    case OpCode::PRINT_STR_LOCAL:
+        return "PRINT_STR_LOCAL";
+    case OpCode::EXIT:
+        return "EXIT";
+    case OpCode::HALT:
+        return "HALT";
+    case OpCode::INC_GLOBAL:
+        return "INC_GLOBAL";
+    case OpCode::INC_LOCAL:
+        return "INC_LOCAL";
+    case OpCode::BRANCH_GLOBAL:
+        return "BRANCH_GLOBAL";
+    case OpCode::BRANCH_LOCAL:
+        return "BRANCH_LOCAL";
+    case OpCode::MOD_BRANCH_GLOBAL:
+        return "MOD_BRANCH_GLOBAL";
+    case OpCode::MOD_BRANCH_LOCAL:
+        return "MOD_BRANCH_LOCAL";
+    case OpCode::STORE_GLOBAL_ELEM_AT:
+        return "STORE_GLOBAL_ELEM_AT";
+    case OpCode::STORE_LOCAL_ELEM_AT:
+        return "STORE_LOCAL_ELEM_AT";
+    default:
+        return "INVALID_OPCODE";
+    }
+}
+
+bool BytecodeProgram::isJump(OpCode op) {
+    switch (op) {
+    case OpCode::JUMP:
+    case OpCode::JUMP_IF_FALSE:
+    case OpCode::BRANCH_GLOBAL:
+    case OpCode::BRANCH_LOCAL:
+    case OpCode::MOD_BRANCH_GLOBAL:
+    case OpCode::MOD_BRANCH_LOCAL:
+        return true;
+    default:
+        return false;
+    }
+}
+
+int &BytecodeProgram::target(Instruction &ins) {
+    return isSuperinstruction(ins.op) ? ins.c : ins.a;
+}
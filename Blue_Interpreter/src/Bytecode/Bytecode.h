@@ -0,0 +1,101 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Instruction set of the bytecode VM. Operands are stored in the 'a' and 'b'
+// fields of each instruction, jump targets are absolute instruction indices.
+// The superinstructions after HALT are only made by fuseSuperinstructions and
+// also use 'c' and 'cond'.
+enum class OpCode : uint8_t {
+    PUSH,              // push constant a
+    POP,               // discard top of stack
+    LOAD_GLOBAL,       // push globals[a]
+    STORE_GLOBAL,      // pop into globals[a]
+    LOAD_LOCAL,        // push frame[a]
+    STORE_LOCAL,       // pop into frame[a]
+    LOAD_GLOBAL_ELEM,  // pop index, push globals[a + index] (b = array size)
+    STORE_GLOBAL_ELEM, // pop value, pop index, store (b = array size)
+    LOAD_LOCAL_ELEM,   // pop index, push frame[a + index] (b = array size)
+    STORE_LOCAL_ELEM,  // pop value, pop index, store (b = array size)
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    MOD,
+    POW,
+    AND,
+    OR,
+    EQ,
+    NE,
+    LT,
+    GT,
+    LE,
+    GE,
+    NOT,
+    JUMP,          // jump to a
+    JUMP_IF_FALSE, // pop, jump to a when zero
+    CALL,          // call function a, arguments are on the stack
+    RETURN,        // pop return value, leave the current frame
+    PRINT_INT,     // pop and print as decimal
+    PRINT_TEXT,    // print string pool entry a
+    PRINT_STR_GLOBAL, // print char array globals[a .. a + b)
+    PRINT_STR_LOCAL,  // print char array frame[a .. a + b)
+    EXIT,             // terminate the process with status a
+    HALT,             // end of program
+
+    INC_GLOBAL,        // globals[a] += b
+    INC_LOCAL,         // frame[a] += b
+    BRANCH_GLOBAL,     // jump to c unless globals[a] <cond> b
+    BRANCH_LOCAL,      // jump to c unless frame[a] <cond> b
+    MOD_BRANCH_GLOBAL, // jump to c unless globals[a] % b <cond> 0
+    MOD_BRANCH_LOCAL,  // jump to c unless frame[a] % b <cond> 0
+    STORE_GLOBAL_ELEM_AT, // pop value, store at index frame[c] (b = array size)
+    STORE_LOCAL_ELEM_AT,  // pop value, store at index frame[c] (b = array size)
+};
+
+const int OpCodeCount = static_cast<int>(OpCode::STORE_LOCAL_ELEM_AT) + 1;
+
+inline bool isSuperinstruction(OpCode op) { return op > OpCode::HALT; }
+
+struct Instruction {
+    OpCode op;
+    OpCode cond = OpCode::EQ; // comparison of the BRANCH superinstructions
+    int a = 0;
+    int b = 0;
+    int c = 0;
+};
+
+// Everything the VM needs to know about a function or procedure, computed
+// once by the compiler
+struct FunctionInfo {
+    std::string name;
+    int entry = 0;     // index of the first instruction of the body
+    int frameSize = 0; // slots needed for parameters and locals
+    bool returnsValue = false;
+    std::vector<int> paramOffsets; // frame slot of each parameter, in order
+};
+
+class BytecodeProgram {
+  public:
+    std::vector<Instruction> code;
+    std::vector<int> lines;           // source line of each instruction
+    std::vector<std::string> strings; // literal text used by PRINT_TEXT
+    std::vector<FunctionInfo> functions;
+    int numGlobals = 0;
+
+    // Append an instruction and return its index
+    int emit(OpCode op, int a = 0, int b = 0, int line = 0);
+
+    // Add a string to the pool and return its index
+    int addString(const std::string &text);
+
+    static std::string opCodeToString(OpCode op);
+    static bool isJump(OpCode op);
+    // Index of the instruction 'ins' jumps to, only valid if isJump
+    static int &target(Instruction &ins);
+};
+
+#endif // BYTECODE_H
@@ -0,0 +1,568 @@
+#include "BytecodeCompiler.h"
+#include "../CST/Parser.h"
+#include "../ErrorHandler/ErrorHandler.h"
+#include "Superinstructions.h"
+#include <stdexcept>
+
+using namespace std;
+
+BytecodeCompiler::BytecodeCompiler(const NodePtr &astRoot,
+                                   const SymbolResolver &resolver)
+    : astRoot(astRoot), resolver(resolver) {}
+
+BytecodeProgram BytecodeCompiler::compile() {
+    buildLayout();
+
+    if (!isFunction("main")) {
+        throw std::runtime_error("Function or Procedure not found.");
+    }
+
+    // Program entry: call main and stop once it returns
+    int mainIndex = functionIndex["main"];
+    for (int i = 0; i < program.functions[mainIndex].paramOffsets.size(); ++i)
+        program.emit(OpCode::PUSH, 0);
+    program.emit(OpCode::CALL, mainIndex);
+    program.emit(OpCode::HALT);
+
+    // Functions and procedures appear in the AST in the same order as their
+    // symbol tables, everything else at the top level is a global declaration
+    int functionCount = 0;
+    NodePtr row = astRoot;
+    while (row) {
+        const string &value = row->value.value();
+        if (row->getSemanticType() == Node::Type::DECLARATION &&
+            (value == "function" || value == "procedure")) {
+            row = compileFunction(row, functionCount++);
+        } else {
+            row = nextRow(row);
+        }
+    }
+
+    fuseSuperinstructions(program);
+    return program;
+}
+
+// Frame layouts come from the SymbolResolver, globals live in one shared
+// area and every function gets a FunctionInfo describing its frame
+void BytecodeCompiler::buildLayout() {
+    program.numGlobals = resolver.frame(0).size;
+
+    for (int frame = 1; frame < resolver.frameCount(); ++frame) {
+        const FrameLayout &layout = resolver.frame(frame);
+        if (layout.owner.empty())
+            continue;
+
+        FunctionInfo info;
+        info.name = layout.owner;
+        info.returnsValue = layout.isFunction;
+        info.frameSize = layout.size;
+        info.paramOffsets = layout.paramSlots;
+
+        functionIndex[layout.owner] = static_cast<int>(program.functions.size());
+        program.functions.push_back(info);
+    }
+}
+
+// Every statement in the AST is a row of right siblings, the next statement
+// hangs off the left child of the last node in the row
+NodePtr BytecodeCompiler::nextRow(NodePtr row) {
+    while (row->Right())
+        row = row->Right();
+    return row->Left();
+}
+
+vector<NodePtr> BytecodeCompiler::rowNodes(NodePtr first) {
+    vector<NodePtr> nodes;
+    for (NodePtr node = first; node; node = node->Right())
+        nodes.push_back(node);
+    return nodes;
+}
+
+NodePtr BytecodeCompiler::compileFunction(NodePtr declarationRow, int index) {
+    program.functions[index].entry = static_cast<int>(program.code.size());
+
+    NodePtr next = compileBlockOrStatement(nextRow(declarationRow));
+
+    // Falling off the end of a body returns 0
+    program.emit(OpCode::PUSH, 0);
+    program.emit(OpCode::RETURN);
+
+    return next;
+}
+
+NodePtr BytecodeCompiler::compileBlockOrStatement(NodePtr row) {
+    if (!row) {
+        throw std::runtime_error("Unexpected end of AST while compiling.");
+    }
+
+    if (row->getSemanticType() != Node::Type::BEGIN_BLOCK)
+        return compileStatement(row);
+
+    row = nextRow(row);
+    while (row && row->getSemanticType() != Node::Type::END_BLOCK)
+        row = compileStatement(row);
+
+    if (!row) {
+        _globalErrorHandler.handle(6, 0);
+    }
+    return nextRow(row);
+}
+
+// Compiles the statement starting at 'row' and returns the row following it
+NodePtr BytecodeCompiler::compileStatement(NodePtr row) {
+    int line = static_cast<int>(row->value.lineNum());
+
+    switch (row->getSemanticType()) {
+    case Node::Type::DECLARATION:
+        // storage is reserved up front, nothing to do at run time
+        return nextRow(row);
+    case Node::Type::ASSIGNMENT:
+        compileAssignment(rowNodes(row->Right()));
+        return nextRow(row);
+    case Node::Type::IF:
+        return compileIF(row);
+    case Node::Type::WHILE:
+        return compileWhile(row);
+    case Node::Type::FOR:
+        return compileFor(row);
+    case Node::Type::CALL:
+        compileCall(row);
+        return nextRow(row);
+    case Node::Type::PRINTF:
+        compilePrintF(row);
+        return nextRow(row);
+    case Node::Type::RETURN: {
+        vector<NodePtr> nodes = rowNodes(row->Right());
+        if (nodes.empty())
+            program.emit(OpCode::PUSH, 0, 0, line);
+        else
+            compileExpression(nodes, 0, nodes.size());
+        program.emit(OpCode::RETURN, 0, 0, line);
+        return nextRow(row);
+    }
+    case Node::Type::BEGIN_BLOCK:
+        return compileBlockOrStatement(row);
+    default:
+        _globalErrorHandler.handle(13, line);
+        return nullptr;
+    }
+}
+
+NodePtr BytecodeCompiler::compileIF(NodePtr row) {
+    int line = static_cast<int>(row->value.lineNum());
+    vector<NodePtr> condition = rowNodes(row->Right());
+    compileExpression(condition, 0, condition.size());
+
+    int skipIf = program.emit(OpCode::JUMP_IF_FALSE, 0, 0, line);
+    NodePtr next = compileBlockOrStatement(nextRow(row));
+
+    if (next && next->getSemanticType() == Node::Type::ELSE) {
+        int skipElse = program.emit(OpCode::JUMP, 0, 0, line);
+        patchJump(skipIf);
+        next = compileBlockOrStatement(nextRow(next));
+        patchJump(skipElse);
+    } else {
+        patchJump(skipIf);
+    }
+    return next;
+}
+
+NodePtr BytecodeCompiler::compileWhile(NodePtr row) {
+    int line = static_cast<int>(row->value.lineNum());
+    int loopStart = static_cast<int>(program.code.size());
+
+    vector<NodePtr> condition = rowNodes(row->Right());
+    compileExpression(condition, 0, condition.size());
+    int exitLoop = program.emit(OpCode::JUMP_IF_FALSE, 0, 0, line);
+
+    NodePtr next = compileBlockOrStatement(nextRow(row));
+    program.emit(OpCode::JUMP, loopStart, 0, line);
+    patchJump(exitLoop);
+    return next;
+}
+
+NodePtr BytecodeCompiler::compileFor(NodePtr row) {
+    int line = static_cast<int>(row->value.lineNum());
+    NodePtr initRow = nextRow(row);          // For_Expression_1
+    NodePtr conditionRow = nextRow(initRow); // For_Expression_2
+    NodePtr updateRow = nextRow(conditionRow); // For_Expression_3
+
+    compileAssignment(rowNodes(initRow->Right()));
+
+    int loopStart = static_cast<int>(program.code.size());
+    vector<NodePtr> condition = rowNodes(conditionRow->Right());
+    compileExpression(condition, 0, condition.size());
+    int exitLoop = program.emit(OpCode::JUMP_IF_FALSE, 0, 0, line);
+
+    NodePtr next = compileBlockOrStatement(nextRow(updateRow));
+    compileAssignment(rowNodes(updateRow->Right()));
+    program.emit(OpCode::JUMP, loopStart, 0, line);
+    patchJump(exitLoop);
+    return next;
+}
+
+void BytecodeCompiler::compileCall(NodePtr row) {
+    const string &name = row->value.value();
+    int line = static_cast<int>(row->value.lineNum());
+
+    if (!isFunction(name)) {
+        throw std::runtime_error("Function or Procedure not found.");
+    }
+    int index = functionIndex[name];
+
+    vector<NodePtr> args = rowNodes(row->Right());
+    size_t i = 0;
+    for (int param = 0; param < program.functions[index].paramOffsets.size();
+         ++param) {
+        if (i >= args.size()) {
+            _globalErrorHandler.handle(37, line);
+        }
+        i = compileOperand(args, i, args.size(), true);
+    }
+
+    program.emit(OpCode::CALL, index, 0, line);
+    program.emit(OpCode::POP, 0, 0, line); // result of a call statement unused
+}
+
+void BytecodeCompiler::compileAssignment(const vector<NodePtr> &nodes) {
+    if (nodes.empty() ||
+        nodes.back()->value.type() != Token::Type::AssignmentOperator) {
+        _globalErrorHandler.handle(
+            16, nodes.empty() ? 0 : nodes.front()->value.lineNum());
+    }
+
+    const Token &target = nodes.front()->value;
+    int line = static_cast<int>(target.lineNum());
+    if (target.type() != Token::Type::Identifier) {
+        _globalErrorHandler.handle(34, line);
+    }
+    const SlotBinding &var = lookup(nodes.front());
+
+    size_t valueStart = 1;
+    size_t valueEnd = nodes.size() - 1; // skip the trailing '='
+    bool indexed = nodes.size() > 1 &&
+                   nodes[1]->value.type() == Token::Type::LBracket;
+
+    if (indexed) {
+        size_t close = matchingBracket(nodes, 1);
+        compileExpression(nodes, 2, close);
+        valueStart = close + 1;
+    } else if (var.isArray && var.dataType == "char") {
+        // whole char arrays can only be assigned a string literal
+        if (valueEnd - valueStart != 1 ||
+            (nodes[valueStart]->value.type() !=
+                 Token::Type::DoubleQuotedString &&
+             nodes[valueStart]->value.type() !=
+                 Token::Type::SingleQuotedString)) {
+            _globalErrorHandler.handle(35, line);
+        }
+        compileStringAssignment(var, nodes[valueStart]);
+        return;
+    }
+
+    if (valueStart >= valueEnd) {
+        _globalErrorHandler.handle(16, line);
+    }
+    compileExpression(nodes, valueStart, valueEnd);
+
+    if (indexed)
+        emitStoreElement(var, line);
+    else
+        emitStore(var, line);
+}
+
+// Copies the characters of a string literal into a char array, stopping at an
+// explicit "\x0" terminator the same way the tree-walking interpreter does
+void BytecodeCompiler::compileStringAssignment(const SlotBinding &var,
+                                               const NodePtr &literal) {
+    const string &text = literal->value.value();
+    int line = static_cast<int>(literal->value.lineNum());
+
+    for (int i = 1; i < text.size() - 1; ++i) {
+        if (text.at(i) == '\\') {
+            i++;
+            if (text.at(i) == 'x') {
+                i++;
+                if (text.at(i) == '0') {
+                    break;
+                }
+            }
+        }
+
+        program.emit(OpCode::PUSH, i - 1, 0, line);
+        program.emit(OpCode::PUSH, text.at(i), 0, line);
+        emitStoreElement(var, line);
+    }
+}
+
+void BytecodeCompiler::compilePrintF(NodePtr row) {
+    int line = static_cast<int>(row->value.lineNum());
+    NodePtr formatNode = row->Right();
+    if (!formatNode) {
+        _globalErrorHandler.handle(21, line);
+    }
+    const string &format = formatNode->value.value();
+
+    // Each argument is an identifier, optionally followed by an index
+    vector<NodePtr> nodes = rowNodes(formatNode->Right());
+    vector<pair<size_t, size_t>> args;
+    for (size_t i = 0; i < nodes.size();) {
+        if (nodes[i]->value.type() != Token::Type::Identifier) {
+            i++;
+            continue;
+        }
+        size_t end = i + 1;
+        if (end < nodes.size() &&
+            nodes[end]->value.type() == Token::Type::LBracket)
+            end = matchingBracket(nodes, end) + 1;
+        args.push_back({i, end});
+        i = end;
+    }
+
+    string text;
+    auto flushText = [&]() {
+        if (!text.empty()) {
+            program.emit(OpCode::PRINT_TEXT, program.addString(text), 0, line);
+            text.clear();
+        }
+    };
+
+    // Without arguments the quotes are dropped and escapes print nothing
+    if (args.empty()) {
+        for (int i = 1; i < format.size() - 1; ++i) {
+            if (format[i] == '\\')
+                i++;
+            else
+                text += format[i];
+        }
+        flushText();
+        return;
+    }
+
+    size_t argIndex = 0;
+    for (int i = 0; i < format.size(); i++) {
+        if (format.at(i) == '%') {
+            i++;
+            flushText();
+            if (format.at(i) != 'd' && format.at(i) != 's') {
+                program.emit(OpCode::EXIT, 411, 0, line);
+                return;
+            }
+            if (argIndex >= args.size()) {
+                throw std::runtime_error("Missing argument for printf on line " +
+                                         to_string(line));
+            }
+            auto [start, end] = args[argIndex++];
+
+            if (format.at(i) == 'd') {
+                compileOperand(nodes, start, end, false);
+                program.emit(OpCode::PRINT_INT, 0, 0, line);
+            } else {
+                const SlotBinding &var = lookup(nodes[start]);
+                program.emit(var.frame == 0 ? OpCode::PRINT_STR_GLOBAL
+                                          : OpCode::PRINT_STR_LOCAL,
+                             var.slot, var.size, line);
+            }
+        } else if (format.at(i) == '\\') {
+            i++;
+            if (format.at(i) == 'n') {
+                text += ' ';
+            } else {
+                flushText();
+                program.emit(OpCode::EXIT, 412, 0, line);
+                return;
+            }
+        } else if (format[i] != '"') {
+            text += format[i];
+        }
+    }
+    flushText();
+}
+
+void BytecodeCompiler::compileExpression(const vector<NodePtr> &nodes,
+                                         size_t begin, size_t end) {
+    size_t i = begin;
+    while (i < end) {
+        if (isOperator(nodes[i]->value) ||
+            nodes[i]->value.type() == Token::Type::AssignmentOperator) {
+            compileOperator(nodes[i]->value);
+            i++;
+        } else {
+            i = compileOperand(nodes, i, end, false);
+        }
+    }
+}
+
+// Compiles a single operand of a postfix expression: a literal, a variable,
+// an array element or a function call with its arguments. Returns the index
+// of the node after the operand.
+size_t BytecodeCompiler::compileOperand(const vector<NodePtr> &nodes, size_t i,
+                                        size_t end, bool isArgument) {
+    const Token &token = nodes[i]->value;
+    int line = static_cast<int>(token.lineNum());
+
+    switch (token.type()) {
+    case Token::Type::Identifier: {
+        const string &name = token.value();
+
+        if (!nodes[i]->binding && isFunction(name)) {
+            int index = functionIndex[name];
+            i++;
+            for (int param = 0;
+                 param < program.functions[index].paramOffsets.size();
+                 ++param) {
+                if (i >= end) {
+                    _globalErrorHandler.handle(37, line);
+                }
+                i = compileOperand(nodes, i, end, true);
+            }
+            program.emit(OpCode::CALL, index, 0, line);
+            return i;
+        }
+
+        const SlotBinding &var = lookup(nodes[i]);
+        if (i + 1 < end &&
+            nodes[i + 1]->value.type() == Token::Type::LBracket) {
+            size_t close = matchingBracket(nodes, i + 1);
+            compileExpression(nodes, i + 2, close);
+            emitLoadElement(var, line);
+            return close + 1;
+        }
+
+        if (isArgument && var.isArray) {
+            _globalErrorHandler.handle(38, line);
+        }
+        emitLoad(var, line);
+        return i + 1;
+    }
+    case Token::Type::Integer:
+        program.emit(OpCode::PUSH, stoi(token.value()), 0, line);
+        return i + 1;
+    case Token::Type::BooleanTrue:
+        program.emit(OpCode::PUSH, 1, 0, line);
+        return i + 1;
+    case Token::Type::BooleanFalse:
+        program.emit(OpCode::PUSH, 0, 0, line);
+        return i + 1;
+    case Token::Type::SingleQuotedString:
+    case Token::Type::DoubleQuotedString:
+        // a single character (string of size 1 + quotes)
+        if (token.value().size() != 3) {
+            _globalErrorHandler.handle(36, line);
+        }
+        program.emit(OpCode::PUSH, token.value()[1], 0, line);
+        return i + 1;
+    default:
+        _globalErrorHandler.handle(15, line);
+        return i + 1;
+    }
+}
+
+void BytecodeCompiler::compileOperator(const Token &op) {
+    int line = static_cast<int>(op.lineNum());
+
+    switch (op.type()) {
+    case Token::Type::Plus:
+        program.emit(OpCode::ADD, 0, 0, line);
+        break;
+    case Token::Type::Minus:
+        program.emit(OpCode::SUB, 0, 0, line);
+        break;
+    case Token::Type::Asterisk:
+        program.emit(OpCode::MUL, 0, 0, line);
+        break;
+    case Token::Type::Slash:
+        program.emit(OpCode::DIV, 0, 0, line);
+        break;
+    case Token::Type::Modulo:
+        program.emit(OpCode::MOD, 0, 0, line);
+        break;
+    case Token::Type::Caret:
+        program.emit(OpCode::POW, 0, 0, line);
+        break;
+    case Token::Type::BooleanAnd:
+        program.emit(OpCode::AND, 0, 0, line);
+        break;
+    case Token::Type::BooleanOr:
+        program.emit(OpCode::OR, 0, 0, line);
+        break;
+    case Token::Type::BooleanEqual:
+        program.emit(OpCode::EQ, 0, 0, line);
+        break;
+    case Token::Type::BooleanNotEqual:
+        program.emit(OpCode::NE, 0, 0, line);
+        break;
+    case Token::Type::Lt:
+        program.emit(OpCode::LT, 0, 0, line);
+        break;
+    case Token::Type::Gt:
+        program.emit(OpCode::GT, 0, 0, line);
+        break;
+    case Token::Type::LtEqual:
+        program.emit(OpCode::LE, 0, 0, line);
+        break;
+    case Token::Type::GtEqual:
+        program.emit(OpCode::GE, 0, 0, line);
+        break;
+    case Token::Type::BooleanNot:
+        program.emit(OpCode::NOT, 0, 0, line);
+        break;
+    default:
+        // '=' is only valid as the last node of an assignment
+        _globalErrorHandler.handle(33, line);
+    }
+}
+
+size_t BytecodeCompiler::matchingBracket(const vector<NodePtr> &nodes,
+                                         size_t open) {
+    int depth = 0;
+    for (size_t i = open; i < nodes.size(); ++i) {
+        if (nodes[i]->value.type() == Token::Type::LBracket)
+            depth++;
+        else if (nodes[i]->value.type() == Token::Type::RBracket &&
+                 --depth == 0)
+            return i;
+    }
+    _globalErrorHandler.handle(5, nodes[open]->value.lineNum());
+    return nodes.size();
+}
+
+const SlotBinding &BytecodeCompiler::lookup(const NodePtr &node) {
+    if (!node->binding) {
+        throw std::runtime_error("No Symbol Table for " + node->value.value() +
+                                 " on line " +
+                                 to_string(node->value.lineNum()));
+    }
+    return *node->binding;
+}
+
+bool BytecodeCompiler::isFunction(const string &name) const {
+    return functionIndex.find(name) != functionIndex.end();
+}
+
+void BytecodeCompiler::emitLoad(const SlotBinding &var, int line) {
+    program.emit(var.frame == 0 ? OpCode::LOAD_GLOBAL : OpCode::LOAD_LOCAL,
+                 var.slot, 0, line);
+}
+
+void BytecodeCompiler::emitStore(const SlotBinding &var, int line) {
+    program.emit(var.frame == 0 ? OpCode::STORE_GLOBAL : OpCode::STORE_LOCAL,
+                 var.slot, 0, line);
+}
+
+void BytecodeCompiler::emitLoadElement(const SlotBinding &var, int line) {
+    program.emit(var.frame == 0 ? OpCode::LOAD_GLOBAL_ELEM
+                              : OpCode::LOAD_LOCAL_ELEM,
+                 var.slot, var.size, line);
+}
+
+void BytecodeCompiler::emitStoreElement(const SlotBinding &var, int line) {
+    program.emit(var.frame == 0 ? OpCode::STORE_GLOBAL_ELEM
+                              : OpCode::STORE_LOCAL_ELEM,
+                 var.slot, var.size, line);
+}
+
+// Points a previously emitted jump at the next instruction to be emitted
+void BytecodeCompiler::patchJump(int instruction) {
+    program.code[instruction].a = static_cast<int>(program.code.size());
+}
@@ -0,0 +1,61 @@
+#ifndef BYTECODECOMPILER_H
+#define BYTECODECOMPILER_H
+
+#include "../Node/Node.h"
+#include "../SymbolTable/SymbolResolver.h"
+#include "Bytecode.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Lowers the AST produced by ASTParser into a flat BytecodeProgram. Variables
+// use the global or frame slots bound by SymbolResolver and every jump target
+// is patched in during compilation, so the VM never has to look at a Node
+// again.
+class BytecodeCompiler {
+  public:
+    BytecodeCompiler(const NodePtr &astRoot, const SymbolResolver &resolver);
+
+    BytecodeProgram compile();
+
+  private:
+    NodePtr astRoot = nullptr;
+    const SymbolResolver &resolver;
+    BytecodeProgram program;
+
+    std::unordered_map<std::string, int> functionIndex;
+
+    void buildLayout();
+
+    NodePtr nextRow(NodePtr row);
+    std::vector<NodePtr> rowNodes(NodePtr first);
+
+    NodePtr compileFunction(NodePtr declarationRow, int index);
+    NodePtr compileBlockOrStatement(NodePtr row);
+    NodePtr compileStatement(NodePtr row);
+    NodePtr compileIF(NodePtr row);
+    NodePtr compileWhile(NodePtr row);
+    NodePtr compileFor(NodePtr row);
+    void compileCall(NodePtr row);
+    void compileAssignment(const std::vector<NodePtr> &nodes);
+    void compileStringAssignment(const SlotBinding &var, const NodePtr &literal);
+    void compilePrintF(NodePtr row);
+
+    void compileExpression(const std::vector<NodePtr> &nodes, size_t begin,
+                           size_t end);
+    size_t compileOperand(const std::vector<NodePtr> &nodes, size_t i,
+                          size_t end, bool isArgument);
+    void compileOperator(const Token &op);
+    size_t matchingBracket(const std::vector<NodePtr> &nodes, size_t open);
+
+    const SlotBinding &lookup(const NodePtr &node);
+    bool isFunction(const std::string &name) const;
+
+    void emitLoad(const SlotBinding &var, int line);
+    void emitStore(const SlotBinding &var, int line);
+    void emitLoadElement(const SlotBinding &var, int line);
+    void emitStoreElement(const SlotBinding &var, int line);
+    void patchJump(int instruction);
+};
+
+#endif // BYTECODECOMPILER_H
@@ -0,0 +1,235 @@
+#include "BytecodeVerifier.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// The register form packs a slot into the upper bits of an int operand, see
+// RegisterProgram.h, so frames and globals stay well below that
+const int64_t MaxSlots = int64_t(1) << 28;
+
+bool isTerminator(OpCode op) {
+    return op == OpCode::JUMP || op == OpCode::RETURN || op == OpCode::EXIT ||
+           op == OpCode::HALT;
+}
+
+class Verifier {
+  public:
+    explicit Verifier(const BytecodeProgram &program)
+        : program(program), code(program.code), depthAt(code.size(), -1) {}
+
+    void verify() {
+        if (code.empty() || program.lines.size() != code.size())
+            throw runtime_error("program image has no instructions");
+        if (program.numGlobals < 0 || program.numGlobals > MaxSlots)
+            throw runtime_error("program image has a bad number of globals");
+
+        // code before the first function calls main, then every function
+        // runs up to the entry of the next
+        vector<pair<int, int>> entries; // entry, function
+        for (size_t i = 0; i < program.functions.size(); ++i) {
+            const FunctionInfo &function = program.functions[i];
+            if (function.entry <= 0 ||
+                function.entry >= static_cast<int>(code.size()) ||
+                function.frameSize < 0 || function.frameSize > MaxSlots)
+                throw runtime_error("program image has a bad function " +
+                                    function.name);
+            for (int offset : function.paramOffsets)
+                if (offset < 0 || offset >= function.frameSize)
+                    throw runtime_error("program image has a bad parameter "
+                                        "of " +
+                                        function.name);
+            entries.push_back({function.entry, static_cast<int>(i)});
+        }
+        sort(entries.begin(), entries.end());
+
+        int start = 0;
+        int function = -1;
+        for (const auto &entry : entries) {
+            if (entry.first == start)
+                throw runtime_error("program image has two functions at "
+                                    "one entry");
+            verifyRange(start, entry.first, function);
+            start = entry.first;
+            function = entry.second;
+        }
+        verifyRange(start, static_cast<int>(code.size()), function);
+
+        for (const Jump &jump : jumps)
+            if (depthAt[jump.target] != jump.depth)
+                reject(jump.from, "jumps with a different stack depth");
+    }
+
+  private:
+    struct Jump {
+        int from;
+        int target;
+        int depth; // stack depth it arrives with
+    };
+
+    [[noreturn]] void reject(int pc, const string &problem) const {
+        throw runtime_error("program image instruction " + to_string(pc) +
+                            " " + problem);
+    }
+
+    // Instructions [start, end) of one function, or of the entry code when
+    // 'function' is -1
+    void verifyRange(int start, int end, int function) {
+        this->start = start;
+        this->end = end;
+        frameSize = function < 0 ? 0 : program.functions[function].frameSize;
+        inFunction = function >= 0;
+
+        int depth = 0;
+        for (int pc = start; pc < end; ++pc) {
+            depthAt[pc] = depth;
+            depth = verifyInstruction(pc, depth);
+        }
+        if (!isTerminator(code[end - 1].op))
+            reject(end - 1, "runs off the end of its function");
+    }
+
+    // Checks the instruction at 'pc' and returns the stack depth after it
+    int verifyInstruction(int pc, int depth) {
+        const Instruction &ins = code[pc];
+        if (static_cast<int>(ins.op) >= OpCodeCount)
+            reject(pc, "has an unknown opcode");
+        if (ins.cond < OpCode::EQ || ins.cond > OpCode::GE)
+            reject(pc, "has an unknown comparison");
+
+        int pops = 0;
+        int pushes = 0;
+        switch (ins.op) {
+        case OpCode::PUSH:
+            pushes = 1;
+            break;
+        case OpCode::POP:
+        case OpCode::PRINT_INT:
+            pops = 1;
+            break;
+        case OpCode::LOAD_GLOBAL:
+        case OpCode::LOAD_LOCAL:
+            slot(pc, ins.op == OpCode::LOAD_GLOBAL, ins.a);
+            pushes = 1;
+            break;
+        case OpCode::STORE_GLOBAL:
+        case OpCode::STORE_LOCAL:
+            slot(pc, ins.op == OpCode::STORE_GLOBAL, ins.a);
+            pops = 1;
+            break;
+        case OpCode::LOAD_GLOBAL_ELEM:
+        case OpCode::LOAD_LOCAL_ELEM:
+            array(pc, ins.op == OpCode::LOAD_GLOBAL_ELEM, ins.a, ins.b);
+            pops = 1;
+            pushes = 1;
+            break;
+        case OpCode::STORE_GLOBAL_ELEM:
+        case OpCode::STORE_LOCAL_ELEM:
+            array(pc, ins.op == OpCode::STORE_GLOBAL_ELEM, ins.a, ins.b);
+            pops = 2;
+            break;
+        case OpCode::NOT:
+            pops = 1;
+            pushes = 1;
+            break;
+        case OpCode::JUMP:
+            jump(pc, ins.a, depth);
+            break;
+        case OpCode::JUMP_IF_FALSE:
+            pops = 1;
+            jump(pc, ins.a, depth - 1);
+            break;
+        case OpCode::CALL:
+            if (ins.a < 0 || ins.a >= static_cast<int>(program.functions.size()))
+                reject(pc, "calls a function that doesn't exist");
+            pops = static_cast<int>(program.functions[ins.a].paramOffsets.size());
+            pushes = 1;
+            break;
+        case OpCode::RETURN:
+            if (!inFunction)
+                reject(pc, "returns outside a function");
+            pops = 1;
+            break;
+        case OpCode::PRINT_TEXT:
+            if (ins.a < 0 || ins.a >= static_cast<int>(program.strings.size()))
+                reject(pc, "prints a string that doesn't exist");
+            break;
+        case OpCode::PRINT_STR_GLOBAL:
+        case OpCode::PRINT_STR_LOCAL:
+            array(pc, ins.op == OpCode::PRINT_STR_GLOBAL, ins.a, ins.b);
+            break;
+        case OpCode::EXIT:
+        case OpCode::HALT:
+            break;
+        case OpCode::INC_GLOBAL:
+        case OpCode::INC_LOCAL:
+            slot(pc, ins.op == OpCode::INC_GLOBAL, ins.a);
+            break;
+        case OpCode::BRANCH_GLOBAL:
+        case OpCode::BRANCH_LOCAL:
+        case OpCode::MOD_BRANCH_GLOBAL:
+        case OpCode::MOD_BRANCH_LOCAL:
+            slot(pc,
+                 ins.op == OpCode::BRANCH_GLOBAL ||
+                     ins.op == OpCode::MOD_BRANCH_GLOBAL,
+                 ins.a);
+            jump(pc, ins.c, depth);
+            break;
+        case OpCode::STORE_GLOBAL_ELEM_AT:
+        case OpCode::STORE_LOCAL_ELEM_AT:
+            array(pc, ins.op == OpCode::STORE_GLOBAL_ELEM_AT, ins.a, ins.b);
+            slot(pc, false, ins.c);
+            pops = 1;
+            break;
+        default: // the operators
+            pops = 2;
+            pushes = 1;
+            break;
+        }
+
+        if (pops > depth)
+            reject(pc, "pops more values than the stack holds");
+        return depth - pops + pushes;
+    }
+
+    void slot(int pc, bool global, int index) const {
+        if (index < 0 || index >= (global ? program.numGlobals : frameSize))
+            reject(pc, "uses a slot out of range");
+    }
+
+    void array(int pc, bool global, int first, int size) const {
+        int64_t last = int64_t(first) + size;
+        if (first < 0 || size < 0 ||
+            last > (global ? program.numGlobals : frameSize))
+            reject(pc, "uses an array out of range");
+    }
+
+    void jump(int pc, int target, int depth) {
+        if (target < start || target >= end)
+            reject(pc, "jumps outside its function");
+        jumps.push_back({pc, target, depth});
+    }
+
+    const BytecodeProgram &program;
+    const vector<Instruction> &code;
+    vector<int> depthAt; // stack depth before each instruction
+    vector<Jump> jumps;
+
+    // the function being checked
+    int start = 0;
+    int end = 0;
+    int frameSize = 0;
+    bool inFunction = false;
+};
+
+} // namespace
+
+void verifyBytecode(const BytecodeProgram &program) {
+    Verifier(program).verify();
+}
@@ -0,0 +1,19 @@
+#ifndef BYTECODEVERIFIER_H
+#define BYTECODEVERIFIER_H
+
+#include "Bytecode.h"
+
+// Checks a BytecodeProgram that did not come straight from the compiler, so
+// the VMs can keep trusting their input:
+//
+//     every opcode and comparison is one the VMs know
+//     slots, arrays, strings and called functions are in range
+//     jumps stay inside the function they are in
+//     the stack never runs dry and has the same depth on every path into
+//     an instruction
+//     no function runs off its end into the next one
+//
+// Throws runtime_error naming the first instruction that fails.
+void verifyBytecode(const BytecodeProgram &program);
+
+#endif // BYTECODEVERIFIER_H
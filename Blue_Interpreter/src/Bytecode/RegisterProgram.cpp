@@ -0,0 +1,79 @@
+#include "RegisterProgram.h"
+
+using namespace std;
+
+string RegisterProgram::opToString(RegOp op) {
+    switch (op) {
+    case RegOp::MOVE:
+        return "MOVE";
+    case RegOp::ADD:
+        return "ADD";
+    case RegOp::SUB:
+        return "SUB";
+    case RegOp::MUL:
+        return "MUL";
+    case RegOp::DIV:
+        return "DIV";
+    case RegOp::MOD:
+        return "MOD";
+    case RegOp::POW:
+        return "POW";
+    case RegOp::AND:
+        return "AND";
+    case RegOp::OR:
+        return "OR";
+    case RegOp::EQ:
+        return "EQ";
+    case RegOp::NE:
+        return "NE";
+    case RegOp::LT:
+        return "LT";
+    case RegOp::GT:
+        return "GT";
+    case RegOp::LE:
+        return "LE";
+    case RegOp::GE:
+        return "GE";
+    case RegOp::NOT:
+        return "NOT";
+    case RegOp::LOAD_ELEM:
+        return "LOAD_ELEM";
+    case RegOp::STORE_ELEM:
+        return "STORE_ELEM";
+    case RegOp::JUMP:
+        return "JUMP";
+    case RegOp::JUMP_IF_FALSE:
+        return "JUMP_IF_FALSE";
+    case RegOp::BRANCH:
+        return "BRANCH";
+    case RegOp::CALL:
+        return "CALL";
+    case RegOp::RETURN:
+        return "RETURN";
+    case RegOp::PRINT_INT:
+        return "PRINT_INT";
+    case RegOp::PRINT_TEXT:
+        return "PRINT_TEXT";
+    case RegOp::PRINT_STR:
+        return "PRINT_STR";
+    case RegOp::EXIT:
+        return "EXIT";
+    case RegOp::HALT:
+        return "HALT";
+    default:
+        return "INVALID_OPCODE";
+    }
+}
+
+// #5 for a constant, g3 for a global, r3 for a frame slot
+string RegisterProgram::operandToString(Operand operand) const {
+    int index = operandIndex(operand);
+    switch (operandKind(operand)) {
+    case OperandKind::Constant:
+        return "#" + to_string(constants[index]);
+    case OperandKind::Global:
+        return "g" + to_string(index);
+    default:
+        return "r" + to_string(index);
+    }
+}
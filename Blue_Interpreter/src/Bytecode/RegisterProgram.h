@@ -0,0 +1,84 @@
+#ifndef REGISTERPROGRAM_H
+#define REGISTERPROGRAM_H
+
+#include "Bytecode.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Instruction set of the register VM. Expression temporaries live in
+// numbered registers, extra slots at the end of each frame, and every
+// instruction names its operands directly, so "x = y * 2 + z" is two
+// instructions instead of the stack VM's six.
+enum class RegOp : uint8_t {
+    MOVE, // dst = a
+    ADD,  // dst = a + b, and so on for every binary operator
+    SUB,
+    MUL,
+    DIV,
+    MOD,
+    POW,
+    AND,
+    OR,
+    EQ,
+    NE,
+    LT,
+    GT,
+    LE,
+    GE,
+    NOT,           // dst = !a
+    LOAD_ELEM,     // dst = array a [index b] (extra = array size)
+    STORE_ELEM,    // array dst [index a] = b (extra = array size)
+    JUMP,          // jump to extra
+    JUMP_IF_FALSE, // jump to extra when a is zero
+    BRANCH,        // jump to extra unless a <cond> b
+    CALL,          // call function extra with arguments from register a on,
+                   // the result goes to dst
+    RETURN,        // return a
+    PRINT_INT,     // print a as decimal
+    PRINT_TEXT,    // print string pool entry extra
+    PRINT_STR,     // print char array a (extra = array size)
+    EXIT,          // terminate the process with status extra
+    HALT,          // end of program
+};
+
+const int RegOpCount = static_cast<int>(RegOp::HALT) + 1;
+
+// Where an operand is read or written: a constant pool entry, a global or a
+// slot of the current frame, packed into one int as index << 2 | kind
+using Operand = int32_t;
+
+enum class OperandKind { Constant = 0, Global = 1, Frame = 2 };
+
+inline Operand makeOperand(OperandKind kind, int index) {
+    return index << 2 | static_cast<int>(kind);
+}
+inline OperandKind operandKind(Operand operand) {
+    return static_cast<OperandKind>(operand & 3);
+}
+inline int operandIndex(Operand operand) { return operand >> 2; }
+
+struct RegInstruction {
+    RegOp op;
+    OpCode cond = OpCode::EQ; // comparison of BRANCH
+    int extra = 0;
+    Operand dst = 0;
+    Operand a = 0;
+    Operand b = 0;
+};
+
+class RegisterProgram {
+  public:
+    std::vector<RegInstruction> code;
+    std::vector<int> lines; // source line of each instruction
+    std::vector<int> constants;
+    std::vector<std::string> strings;
+    std::vector<FunctionInfo> functions; // frame sizes include registers
+    int numGlobals = 0;
+    int entryFrameSize = 0; // registers of the code that calls main
+
+    static std::string opToString(RegOp op);
+    std::string operandToString(Operand operand) const;
+};
+
+#endif // REGISTERPROGRAM_H
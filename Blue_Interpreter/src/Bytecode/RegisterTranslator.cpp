@@ -0,0 +1,322 @@
+#include "RegisterTranslator.h"
+
+#include <algorithm>
+
+using namespace std;
+
+RegisterTranslator::RegisterTranslator(const BytecodeProgram &program)
+    : source(program) {}
+
+RegisterProgram RegisterTranslator::translate() {
+    const vector<Instruction> &code = source.code;
+    out.strings = source.strings;
+    out.functions = source.functions;
+    out.numGlobals = source.numGlobals;
+
+    vector<int> functionAt(code.size() + 1, -1);
+    for (size_t i = 0; i < source.functions.size(); ++i)
+        functionAt[source.functions[i].entry] = static_cast<int>(i);
+
+    vector<bool> isTarget(code.size() + 1, false);
+    for (Instruction ins : code)
+        if (BytecodeProgram::isJump(ins.op))
+            isTarget[BytecodeProgram::target(ins)] = true;
+
+    vector<int> newIndex(code.size() + 1, 0);
+    for (size_t i = 0; i < code.size(); ++i) {
+        if (functionAt[i] >= 0) {
+            finishFrame();
+            function = functionAt[i];
+            frameSize = source.functions[function].frameSize;
+            stack.clear();
+            label = out.code.size();
+        } else if (isTarget[i]) {
+            // every path in arrives with the stack in registers
+            materializeAll();
+            label = out.code.size();
+        }
+
+        newIndex[i] = static_cast<int>(out.code.size());
+        line = source.lines[i];
+        translateInstruction(code[i]);
+    }
+    newIndex[code.size()] = static_cast<int>(out.code.size());
+    finishFrame();
+
+    for (RegInstruction &ins : out.code)
+        if (ins.op == RegOp::JUMP || ins.op == RegOp::JUMP_IF_FALSE ||
+            ins.op == RegOp::BRANCH)
+            ins.extra = newIndex[ins.extra];
+    for (FunctionInfo &info : out.functions)
+        info.entry = newIndex[info.entry];
+
+    return move(out);
+}
+
+void RegisterTranslator::finishFrame() {
+    if (function < 0)
+        out.entryFrameSize = static_cast<int>(maxDepth);
+    else
+        out.functions[function].frameSize =
+            frameSize + static_cast<int>(maxDepth);
+    maxDepth = 0;
+}
+
+void RegisterTranslator::translateInstruction(const Instruction &ins) {
+    bool global = false;
+
+    switch (ins.op) {
+    case OpCode::PUSH:
+        push(constant(ins.a));
+        break;
+    case OpCode::POP:
+        pop();
+        break;
+    case OpCode::LOAD_GLOBAL:
+    case OpCode::LOAD_LOCAL:
+        push(variable(ins.op == OpCode::LOAD_GLOBAL, ins.a));
+        break;
+    case OpCode::STORE_GLOBAL:
+    case OpCode::STORE_LOCAL: {
+        Operand target = variable(ins.op == OpCode::STORE_GLOBAL, ins.a);
+        Operand value = pop();
+        materializeReading(target);
+        // the instruction computing the value writes the variable instead
+        if (value == reg(stack.size()) && lastWrites(value))
+            out.code.back().dst = target;
+        else
+            emit(RegOp::MOVE, target, value);
+        break;
+    }
+    case OpCode::LOAD_GLOBAL_ELEM:
+    case OpCode::LOAD_LOCAL_ELEM: {
+        Operand index = pop();
+        Operand result = reg(stack.size());
+        emit(RegOp::LOAD_ELEM, result,
+             variable(ins.op == OpCode::LOAD_GLOBAL_ELEM, ins.a), index,
+             ins.b);
+        push(result);
+        break;
+    }
+    case OpCode::STORE_GLOBAL_ELEM:
+    case OpCode::STORE_LOCAL_ELEM: {
+        Operand value = pop();
+        Operand index = pop();
+        emit(RegOp::STORE_ELEM,
+             variable(ins.op == OpCode::STORE_GLOBAL_ELEM, ins.a), index,
+             value, ins.b);
+        break;
+    }
+    case OpCode::STORE_GLOBAL_ELEM_AT:
+    case OpCode::STORE_LOCAL_ELEM_AT: {
+        Operand value = pop();
+        emit(RegOp::STORE_ELEM,
+             variable(ins.op == OpCode::STORE_GLOBAL_ELEM_AT, ins.a),
+             variable(false, ins.c), value, ins.b);
+        break;
+    }
+    case OpCode::ADD:
+    case OpCode::SUB:
+    case OpCode::MUL:
+    case OpCode::DIV:
+    case OpCode::MOD:
+    case OpCode::POW:
+    case OpCode::AND:
+    case OpCode::OR:
+    case OpCode::EQ:
+    case OpCode::NE:
+    case OpCode::LT:
+    case OpCode::GT:
+    case OpCode::LE:
+    case OpCode::GE: {
+        // both instruction sets list the operators in the same order
+        auto op = static_cast<RegOp>(static_cast<int>(RegOp::ADD) +
+                                     static_cast<int>(ins.op) -
+                                     static_cast<int>(OpCode::ADD));
+        Operand right = pop();
+        Operand left = pop();
+        Operand result = reg(stack.size());
+        emit(op, result, left, right);
+        push(result);
+        break;
+    }
+    case OpCode::NOT: {
+        Operand value = pop();
+        Operand result = reg(stack.size());
+        emit(RegOp::NOT, result, value);
+        push(result);
+        break;
+    }
+    case OpCode::JUMP:
+        materializeAll();
+        emit(RegOp::JUMP, 0, 0, 0, ins.a);
+        break;
+    case OpCode::JUMP_IF_FALSE: {
+        Operand condition = pop();
+        materializeAll();
+        RegInstruction *last = out.code.empty() ? nullptr : &out.code.back();
+        // a comparison followed by the branch becomes one BRANCH
+        if (condition == reg(stack.size()) && lastWrites(condition) &&
+            last->op >= RegOp::EQ && last->op <= RegOp::GE) {
+            last->cond = static_cast<OpCode>(static_cast<int>(OpCode::EQ) +
+                                             static_cast<int>(last->op) -
+                                             static_cast<int>(RegOp::EQ));
+            last->op = RegOp::BRANCH;
+            last->extra = ins.a;
+        } else {
+            emit(RegOp::JUMP_IF_FALSE, 0, condition, 0, ins.a);
+        }
+        break;
+    }
+    case OpCode::BRANCH_GLOBAL:
+        global = true;
+        [[fallthrough]];
+    case OpCode::BRANCH_LOCAL:
+        materializeAll();
+        emit(RegOp::BRANCH, 0, variable(global, ins.a), constant(ins.b),
+             ins.c)
+            .cond = ins.cond;
+        break;
+    case OpCode::MOD_BRANCH_GLOBAL:
+        global = true;
+        [[fallthrough]];
+    case OpCode::MOD_BRANCH_LOCAL: {
+        materializeAll();
+        Operand remainder = reg(stack.size());
+        emit(RegOp::MOD, remainder, variable(global, ins.a), constant(ins.b));
+        emit(RegOp::BRANCH, 0, remainder, constant(0), ins.c).cond = ins.cond;
+        break;
+    }
+    case OpCode::INC_GLOBAL:
+        global = true;
+        [[fallthrough]];
+    case OpCode::INC_LOCAL: {
+        Operand target = variable(global, ins.a);
+        materializeReading(target);
+        emit(RegOp::ADD, target, target, constant(ins.b));
+        break;
+    }
+    case OpCode::CALL: {
+        // the callee may change globals the stack still refers to
+        materializeGlobals();
+        size_t count = source.functions[ins.a].paramOffsets.size();
+        size_t first = stack.size() - count;
+        for (size_t depth = first; depth < stack.size(); ++depth)
+            materialize(depth);
+        stack.resize(first);
+
+        Operand result = reg(first);
+        emit(RegOp::CALL, result, result, 0, ins.a);
+        push(result);
+        break;
+    }
+    case OpCode::RETURN:
+        emit(RegOp::RETURN, 0, pop());
+        break;
+    case OpCode::PRINT_INT:
+        emit(RegOp::PRINT_INT, 0, pop());
+        break;
+    case OpCode::PRINT_TEXT:
+        emit(RegOp::PRINT_TEXT, 0, 0, 0, ins.a);
+        break;
+    case OpCode::PRINT_STR_GLOBAL:
+    case OpCode::PRINT_STR_LOCAL:
+        emit(RegOp::PRINT_STR, 0,
+             variable(ins.op == OpCode::PRINT_STR_GLOBAL, ins.a), 0, ins.b);
+        break;
+    case OpCode::EXIT:
+        emit(RegOp::EXIT, 0, 0, 0, ins.a);
+        break;
+    case OpCode::HALT:
+        emit(RegOp::HALT);
+        break;
+    }
+}
+
+Operand RegisterTranslator::constant(int value) {
+    auto found = constantIndex.find(value);
+    if (found == constantIndex.end()) {
+        found = constantIndex
+                    .emplace(value, static_cast<int>(out.constants.size()))
+                    .first;
+        out.constants.push_back(value);
+    }
+    return makeOperand(OperandKind::Constant, found->second);
+}
+
+Operand RegisterTranslator::variable(bool global, int slot) const {
+    return makeOperand(global ? OperandKind::Global : OperandKind::Frame,
+                       slot);
+}
+
+Operand RegisterTranslator::reg(size_t depth) {
+    maxDepth = max(maxDepth, depth + 1);
+    return makeOperand(OperandKind::Frame,
+                       frameSize + static_cast<int>(depth));
+}
+
+Operand RegisterTranslator::pop() {
+    Operand operand = stack.back();
+    stack.pop_back();
+    return operand;
+}
+
+RegInstruction &RegisterTranslator::emit(RegOp op, Operand dst, Operand a,
+                                         Operand b, int extra) {
+    RegInstruction ins;
+    ins.op = op;
+    ins.dst = dst;
+    ins.a = a;
+    ins.b = b;
+    ins.extra = extra;
+    out.code.push_back(ins);
+    out.lines.push_back(line);
+    return out.code.back();
+}
+
+// True if the last instruction computed 'operand' and nothing jumps past it
+bool RegisterTranslator::lastWrites(Operand operand) const {
+    if (out.code.size() <= label)
+        return false;
+    const RegInstruction &last = out.code.back();
+    switch (last.op) {
+    case RegOp::STORE_ELEM:
+    case RegOp::JUMP:
+    case RegOp::JUMP_IF_FALSE:
+    case RegOp::BRANCH:
+    case RegOp::RETURN:
+    case RegOp::PRINT_INT:
+    case RegOp::PRINT_TEXT:
+    case RegOp::PRINT_STR:
+    case RegOp::EXIT:
+    case RegOp::HALT:
+        return false;
+    default:
+        return last.dst == operand;
+    }
+}
+
+void RegisterTranslator::materialize(size_t depth) {
+    Operand home = reg(depth);
+    if (stack[depth] != home) {
+        emit(RegOp::MOVE, home, stack[depth]);
+        stack[depth] = home;
+    }
+}
+
+void RegisterTranslator::materializeAll() {
+    for (size_t depth = 0; depth < stack.size(); ++depth)
+        materialize(depth);
+}
+
+void RegisterTranslator::materializeReading(Operand variable) {
+    for (size_t depth = 0; depth < stack.size(); ++depth)
+        if (stack[depth] == variable)
+            materialize(depth);
+}
+
+void RegisterTranslator::materializeGlobals() {
+    for (size_t depth = 0; depth < stack.size(); ++depth)
+        if (operandKind(stack[depth]) == OperandKind::Global)
+            materialize(depth);
+}
@@ -0,0 +1,54 @@
+#ifndef REGISTERTRANSLATOR_H
+#define REGISTERTRANSLATOR_H
+
+#include "Bytecode.h"
+#include "RegisterProgram.h"
+#include <unordered_map>
+#include <vector>
+
+// Turns a stack BytecodeProgram into a RegisterProgram. The operand stack
+// is simulated while translating: constants and variables are pushed as
+// operands without emitting anything, and operators, calls and stores emit
+// one instruction that names its operands directly. A value that has to
+// exist at run time while it is at depth d of the stack is kept in register
+// d, the frame slot frameSize + d of the function it belongs to.
+class RegisterTranslator {
+  public:
+    explicit RegisterTranslator(const BytecodeProgram &program);
+
+    RegisterProgram translate();
+
+  private:
+    void translateInstruction(const Instruction &ins);
+    void finishFrame();
+
+    Operand constant(int value);
+    Operand variable(bool global, int slot) const;
+    Operand reg(size_t depth);
+    Operand pop();
+    void push(Operand operand) { stack.push_back(operand); }
+
+    RegInstruction &emit(RegOp op, Operand dst = 0, Operand a = 0,
+                         Operand b = 0, int extra = 0);
+    bool lastWrites(Operand operand) const;
+
+    // Moves stack entries that are still a constant or a variable into
+    // their registers
+    void materialize(size_t depth);
+    void materializeAll();
+    void materializeReading(Operand variable);
+    void materializeGlobals();
+
+    const BytecodeProgram &source;
+    RegisterProgram out;
+
+    std::unordered_map<int, int> constantIndex;
+    std::vector<Operand> stack;
+    int frameSize = 0;   // slots of the current function before its registers
+    size_t maxDepth = 0; // registers the current function needs
+    int function = -1;   // -1 for the code that calls main
+    int line = 0;        // of the instruction being translated
+    size_t label = 0;    // instructions before it may be jumped over
+};
+
+#endif // REGISTERTRANSLATOR_H
@@ -0,0 +1,189 @@
+#include "Superinstructions.h"
+
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+bool isLoad(OpCode op) {
+    return op == OpCode::LOAD_GLOBAL || op == OpCode::LOAD_LOCAL;
+}
+
+bool isComparison(OpCode op) {
+    return op >= OpCode::EQ && op <= OpCode::GE;
+}
+
+// Values an instruction that can appear inside an expression pops and
+// pushes, false for anything else
+bool stackEffect(const BytecodeProgram &program, const Instruction &ins,
+                 int &pops, int &pushes) {
+    switch (ins.op) {
+    case OpCode::PUSH:
+    case OpCode::LOAD_GLOBAL:
+    case OpCode::LOAD_LOCAL:
+        pops = 0;
+        pushes = 1;
+        return true;
+    case OpCode::LOAD_GLOBAL_ELEM:
+    case OpCode::LOAD_LOCAL_ELEM:
+    case OpCode::NOT:
+        pops = 1;
+        pushes = 1;
+        return true;
+    case OpCode::CALL:
+        // every call leaves a value, procedures a 0
+        pops = static_cast<int>(program.functions[ins.a].paramOffsets.size());
+        pushes = 1;
+        return true;
+    default:
+        if (ins.op >= OpCode::ADD && ins.op <= OpCode::GE) {
+            pops = 2;
+            pushes = 1;
+            return true;
+        }
+        return false;
+    }
+}
+
+class Fuser {
+  public:
+    explicit Fuser(BytecodeProgram &program)
+        : program(program), code(program.code),
+          isTarget(code.size() + 1, false), removed(code.size(), false) {
+        for (Instruction &ins : code)
+            if (BytecodeProgram::isJump(ins.op))
+                isTarget[BytecodeProgram::target(ins)] = true;
+        for (const FunctionInfo &function : program.functions)
+            isTarget[function.entry] = true;
+    }
+
+    void run() {
+        fuseElementStores();
+
+        vector<Instruction> fused;
+        vector<int> lines;
+        vector<int> newIndex(code.size() + 1, 0);
+        for (size_t i = 0; i < code.size();) {
+            newIndex[i] = static_cast<int>(fused.size());
+            if (removed[i]) {
+                i++;
+                continue;
+            }
+            Instruction ins;
+            size_t length = match(i, ins);
+            if (length == 0) {
+                ins = code[i];
+                length = 1;
+            }
+            fused.push_back(ins);
+            lines.push_back(program.lines[i]);
+            i += length;
+        }
+        newIndex[code.size()] = static_cast<int>(fused.size());
+
+        for (Instruction &ins : fused)
+            if (BytecodeProgram::isJump(ins.op))
+                BytecodeProgram::target(ins) =
+                    newIndex[BytecodeProgram::target(ins)];
+        for (FunctionInfo &function : program.functions)
+            function.entry = newIndex[function.entry];
+
+        code = move(fused);
+        program.lines = move(lines);
+    }
+
+  private:
+    // True if code[first, first + length) exists and can become one
+    // instruction
+    bool fusible(size_t first, size_t length) const {
+        if (first + length > code.size())
+            return false;
+        for (size_t i = first; i < first + length; ++i)
+            if ((i > first && isTarget[i]) || removed[i])
+                return false;
+        return true;
+    }
+
+    // Length of the sequence at 'i' that 'ins' replaces, 0 if none does
+    size_t match(size_t i, Instruction &ins) const {
+        if (!isLoad(code[i].op) || !fusible(i, 4) ||
+            code[i + 1].op != OpCode::PUSH)
+            return 0;
+        bool global = code[i].op == OpCode::LOAD_GLOBAL;
+        ins.a = code[i].a;
+        ins.b = code[i + 1].a;
+
+        // x % k == 0 or != 0, then a branch
+        if (code[i + 2].op == OpCode::MOD && fusible(i, 6) &&
+            code[i + 3].op == OpCode::PUSH && code[i + 3].a == 0 &&
+            (code[i + 4].op == OpCode::EQ || code[i + 4].op == OpCode::NE) &&
+            code[i + 5].op == OpCode::JUMP_IF_FALSE) {
+            ins.op = global ? OpCode::MOD_BRANCH_GLOBAL
+                            : OpCode::MOD_BRANCH_LOCAL;
+            ins.cond = code[i + 4].op;
+            ins.c = code[i + 5].a;
+            return 6;
+        }
+
+        // x <cond> k, then a branch
+        if (isComparison(code[i + 2].op) &&
+            code[i + 3].op == OpCode::JUMP_IF_FALSE) {
+            ins.op = global ? OpCode::BRANCH_GLOBAL : OpCode::BRANCH_LOCAL;
+            ins.cond = code[i + 2].op;
+            ins.c = code[i + 3].a;
+            return 4;
+        }
+
+        // x = x + k or x = x - k
+        OpCode store = global ? OpCode::STORE_GLOBAL : OpCode::STORE_LOCAL;
+        if ((code[i + 2].op == OpCode::ADD || code[i + 2].op == OpCode::SUB) &&
+            code[i + 3].op == store && code[i + 3].a == ins.a) {
+            ins.op = global ? OpCode::INC_GLOBAL : OpCode::INC_LOCAL;
+            if (code[i + 2].op == OpCode::SUB)
+                ins.b = -ins.b;
+            return 4;
+        }
+        return 0;
+    }
+
+    // a[i] = expr pushes i, then the value, then stores. When i is a local
+    // the store reads it itself, nothing the expression calls can change it.
+    void fuseElementStores() {
+        for (size_t first = 0; first < code.size(); ++first) {
+            if (code[first].op != OpCode::LOAD_LOCAL || isTarget[first])
+                continue;
+
+            int depth = 1; // the index, at the bottom
+            for (size_t i = first + 1; i < code.size() && !isTarget[i]; ++i) {
+                OpCode op = code[i].op;
+                if (depth == 2 && (op == OpCode::STORE_GLOBAL_ELEM ||
+                                   op == OpCode::STORE_LOCAL_ELEM)) {
+                    code[i].op = op == OpCode::STORE_GLOBAL_ELEM
+                                     ? OpCode::STORE_GLOBAL_ELEM_AT
+                                     : OpCode::STORE_LOCAL_ELEM_AT;
+                    code[i].c = code[first].a;
+                    removed[first] = true;
+                    break;
+                }
+
+                int pops, pushes;
+                if (!stackEffect(program, code[i], pops, pushes) ||
+                    depth - pops < 1)
+                    break;
+                depth += pushes - pops;
+            }
+        }
+    }
+
+    BytecodeProgram &program;
+    vector<Instruction> &code;
+    vector<bool> isTarget; // something jumps to or calls this instruction
+    vector<bool> removed;  // a LOAD_LOCAL taken into a STORE_*_ELEM_AT
+};
+
+} // namespace
+
+void fuseSuperinstructions(BytecodeProgram &program) {
+    Fuser(program).run();
+}
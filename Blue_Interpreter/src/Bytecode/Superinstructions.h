@@ -0,0 +1,18 @@
+#ifndef SUPERINSTRUCTIONS_H
+#define SUPERINSTRUCTIONS_H
+
+#include "Bytecode.h"
+
+// Peephole pass replacing the instruction sequences of the most common
+// statement shapes with one superinstruction each:
+//
+//     x = x + k, x = x - k        INC_GLOBAL, INC_LOCAL
+//     x < k, as a loop or if test BRANCH_GLOBAL, BRANCH_LOCAL
+//     (x % k) == 0, != 0          MOD_BRANCH_GLOBAL, MOD_BRANCH_LOCAL
+//     a[i] = expr, i a local      STORE_GLOBAL_ELEM_AT, STORE_LOCAL_ELEM_AT
+//
+// A sequence is only fused when nothing jumps into the middle of it. Jump
+// targets and function entries are renumbered afterwards.
+void fuseSuperinstructions(BytecodeProgram &program);
+
+#endif // SUPERINSTRUCTIONS_H
@@ -5,16 +5,17 @@
 
 using namespace std;
 
-Parser::Parser(const std::vector<Token> &tokens) : tokens(tokens) {}
+Parser::Parser(TokenStream &tokens, NodeArena &arena)
+    : tokens(tokens), arena(arena) {}
 
 NodePtr Parser::parse() {
 
-    while (current < tokens.size()) {
+    while (tokens.peek()) {
 
         Token t = peekToken();
 
         if (t.type() == Token::Type::Identifier) {
-            string tokenValue = t.value();
+            const string &tokenValue = t.value();
             if (isDataType(tokenValue)) {
                 parseDeclaration();
             } else if (tokenValue == "procedure") {
@@ -23,8 +24,10 @@ NodePtr Parser::parse() {
                 parseFunction();
             } else { // error, global scope can only contain global variable
                 // declarations, procedures, and functions
-                _globalErrorHandler.handle(2, t.lineNum());
+                syntaxError(2, t.lineNum());
             }
+        } else { // nothing else may start a global declaration
+            syntaxError(2, t.lineNum());
         }
     }
 
@@ -32,8 +35,10 @@ NodePtr Parser::parse() {
 }
 
 Token Parser::getToken() {
-    if (current < tokens.size()) {
-        return tokens[current++]; // Corrected to avoid returning a reference
+    if (const Token *token = tokens.peek()) {
+        Token current = *token; // copied, the window slot gets reused
+        tokens.advance();
+        return current;
     } else {
         throw std::runtime_error("Unexpected end of input");
     }
@@ -53,7 +58,7 @@ void Parser::addToCST(NodePtr node, InsertionMode mode) {
 
 NodePtr Parser::createNodePtr(const Token &token) {
     // Create a Node object with the provided Token
-    NodePtr nodePtr = std::make_shared<Node>(token);
+    NodePtr nodePtr = arena.create(token);
     return nodePtr;
 }
 
@@ -78,7 +83,7 @@ void Parser::parseDeclaration() {
         // semicolon check and add
         currToken = getToken();
         if (!match(Token::Type::Semicolon, currToken)) { // ERROR reserved name
-            _globalErrorHandler.handle(32, currToken.lineNum());
+            syntaxError(32, currToken.lineNum());
         }
         addToCST(createNodePtr(currToken), RightSibling); // add name id to CST
     }
@@ -100,7 +105,7 @@ void Parser::parseIDENTIFIER_ARRAY_LIST() {
 
     while (match(Token::Type::Identifier, currToken) && !foundEnd) {
         if (isReserved(currToken.value())) { // check reserved
-            _globalErrorHandler.handle(3, currToken.lineNum());
+            syntaxError(3, currToken.lineNum());
         }
 
         if (match(Token::Type::LBracket, nextToken)) {
@@ -111,12 +116,12 @@ void Parser::parseIDENTIFIER_ARRAY_LIST() {
 
             Token num = getToken();
             if (isReserved(num.value())) { // check reserved
-                _globalErrorHandler.handle(3, currToken.lineNum());
+                syntaxError(3, currToken.lineNum());
             }
             if (num.value()[0] == '-' &&
                 !match(Token::Type::Identifier,
                        num)) { // ERROR negative array size
-                _globalErrorHandler.handle(4, num.lineNum());
+                syntaxError(4, num.lineNum());
             }
             addToCST(createNodePtr((num)),
                      RightSibling); // add num/variable name
@@ -124,7 +129,7 @@ void Parser::parseIDENTIFIER_ARRAY_LIST() {
             nextToken = getToken(); // get right bracket
             if (!match(Token::Type::RBracket,
                        nextToken)) { // incomplete bracket
-                _globalErrorHandler.handle(5, nextToken.lineNum());
+                syntaxError(5, nextToken.lineNum());
             }
             addToCST(createNodePtr((nextToken)),
                      RightSibling); // add right bracket
@@ -152,7 +157,7 @@ void Parser::parseIDENTIFIER_LIST() {
 
     while (match(Token::Type::Identifier, currToken) && !foundEnd) {
         if (isReserved(currToken.value())) {
-            _globalErrorHandler.handle(3, currToken.lineNum());
+            syntaxError(3, currToken.lineNum());
         }
 
         // next token not bracket
@@ -176,7 +181,7 @@ void Parser::parseIDENTIFIER_LIST() {
 void Parser::parseBlockStatement() {
     Token currToken = peekToken();
     if (!match(Token::Type::LBrace, currToken)) {
-        _globalErrorHandler.handle(6, currToken.lineNum());
+        syntaxError(6, currToken.lineNum());
     }
 
     addToCST(createNodePtr(getToken()), LeftChild);
@@ -185,7 +190,7 @@ void Parser::parseBlockStatement() {
 
     currToken = peekToken();
     if (!match(Token::Type::RBrace, currToken)) {
-        _globalErrorHandler.handle(6, currToken.lineNum());
+        syntaxError(6, currToken.lineNum());
     }
 
     addToCST(createNodePtr(getToken()), LeftChild);
@@ -196,11 +201,11 @@ void Parser::parseProcedure() {
              LeftChild); // add 'procedure' identifier to CST
     Token identifier = getToken();
     if (identifier.type() != Token::Type::Identifier) {
-        _globalErrorHandler.handle(7, identifier.lineNum());
+        syntaxError(7, identifier.lineNum());
     }
 
     if (isReserved(identifier.value()) && identifier.value() != "main") {
-        _globalErrorHandler.handle(3, identifier.lineNum());
+        syntaxError(3, identifier.lineNum());
     }
     // Create a procedure declaration node with identifier and add to CST
     addToCST(createNodePtr(identifier), RightSibling);
@@ -241,18 +246,18 @@ void Parser::parseFunction() {
     Token return_type = getToken();
 
     if (!isDataType(return_type.value())) {
-        _globalErrorHandler.handle(8, return_type.lineNum());
+        syntaxError(8, return_type.lineNum());
     }
 
     addToCST(createNodePtr(return_type), RightSibling);
 
     Token identifier = getToken();
     if (identifier.type() != Token::Type::Identifier) {
-        _globalErrorHandler.handle(7, identifier.lineNum());
+        syntaxError(7, identifier.lineNum());
     }
 
     if (isReserved(identifier.value())) {
-        _globalErrorHandler.handle(3, identifier.lineNum());
+        syntaxError(3, identifier.lineNum());
     }
 
     addToCST(createNodePtr(identifier), RightSibling);
@@ -292,18 +297,18 @@ void Parser::parseParameterList() {
         // Expect a data type specifier
         Token dataTypeToken = getToken();
         if (!isDataType(dataTypeToken.value())) {
-            _globalErrorHandler.handle(9, dataTypeToken.lineNum());
+            syntaxError(9, dataTypeToken.lineNum());
         }
         addToCST(createNodePtr(dataTypeToken), RightSibling);
 
         // Expect an identifier after data type
         Token identifierToken = getToken();
         if (identifierToken.type() != Token::Type::Identifier) {
-            _globalErrorHandler.handle(10, identifierToken.lineNum());
+            syntaxError(10, identifierToken.lineNum());
         }
 
         if (isReserved(identifierToken.value())) {
-            _globalErrorHandler.handle(3, identifierToken.lineNum());
+            syntaxError(3, identifierToken.lineNum());
         }
         addToCST(createNodePtr(identifierToken), RightSibling);
 
@@ -317,14 +322,14 @@ void Parser::parseParameterList() {
             // Expect and consume the array size (a whole number)
             Token arraySizeToken = getToken();
             if (arraySizeToken.type() != Token::Type::Integer) {
-                _globalErrorHandler.handle(11, arraySizeToken.lineNum());
+                syntaxError(11, arraySizeToken.lineNum());
             }
             addToCST(createNodePtr(arraySizeToken), RightSibling);
 
             // Expect and consume ']'
             Token closeBracketToken = getToken();
             if (closeBracketToken.type() != Token::Type::RBracket) {
-                _globalErrorHandler.handle(5, closeBracketToken.lineNum());
+                syntaxError(5, closeBracketToken.lineNum());
             }
             addToCST(createNodePtr(closeBracketToken), RightSibling);
 
@@ -342,7 +347,7 @@ void Parser::parseParameterList() {
                         // parameter
             addToCST(createNodePtr(nextToken), RightSibling);
         } else {
-            _globalErrorHandler.handle(12, nextToken.lineNum());
+            syntaxError(12, nextToken.lineNum());
         }
     }
 }
@@ -396,7 +401,7 @@ void Parser::parseFunctionArguments() {
             addToCST(createNodePtr(getToken()), RightSibling);
         }
         else {
-            _globalErrorHandler.handle(7, argToken.lineNum());
+            syntaxError(7, argToken.lineNum());
         }
 
         // Check if there's another argument after a comma
@@ -418,7 +423,7 @@ void Parser::parseStatement() {
 
     // must be an identifier
     if (!match(Token::Type::Identifier, next)) {
-        _globalErrorHandler.handle(13, next.lineNum());
+        syntaxError(13, next.lineNum());
     }
 
     // these reserved words have statements
@@ -434,7 +439,7 @@ void Parser::parseStatement() {
         else if (next.value() == "return")
             parseReturnStatement();
         else {
-            _globalErrorHandler.handle(13, next.lineNum());
+            syntaxError(13, next.lineNum());
         }
 
     }
@@ -453,7 +458,7 @@ void Parser::parseProcedureStatement() {
     Token token = peekToken();
 
     if (!match(Token::Type::Identifier, token) || isReserved(token.value())) {
-        _globalErrorHandler.handle(3, token.lineNum());
+        syntaxError(3, token.lineNum());
     }
 
     // procedure name
@@ -473,7 +478,7 @@ void Parser::parseSelectionStatement() {
     // if
     Token ifToken = getToken();
     if (ifToken.value() != "if") {
-        _globalErrorHandler.handle(14, ifToken.lineNum());
+        syntaxError(14, ifToken.lineNum());
     }
     addToCST(createNodePtr(ifToken), LeftChild);
 
@@ -597,17 +602,16 @@ void Parser::parseExpression() {
             parseExpression();
         }
     } else {
-        _globalErrorHandler.handle(15, currToken.lineNum());
+        syntaxError(15, currToken.lineNum());
     }
 }
 
 void Parser::parseAssignmentStatement() {
-    Token currtoken = peekToken();
     Token next = peekAhead(1);
 
     if (next.type() != Token::Type::AssignmentOperator &&
         next.type() != Token::Type::LBracket) {
-        _globalErrorHandler.handle(16, next.lineNum());
+        syntaxError(16, next.lineNum());
 
     }
     // array assignment
@@ -622,11 +626,11 @@ void Parser::parseAssignmentStatement() {
 
         if (next.type() != Token::Type::Integer &&
             next.type() != Token::Type::Identifier) {
-            _globalErrorHandler.handle(17, next.lineNum());
+            syntaxError(17, next.lineNum());
         }
 
         if (isReserved(next.value())) {
-            _globalErrorHandler.handle(3, next.lineNum());
+            syntaxError(3, next.lineNum());
         }
 
         // array index
@@ -660,7 +664,7 @@ void Parser::parseAssignmentStatement() {
 
     token = getToken();
     if (token.type() != Token::Type::Semicolon) {
-        _globalErrorHandler.handle(18, next.lineNum());
+        syntaxError(18, next.lineNum());
     }
     addToCST(createNodePtr(token), RightSibling);
 } // not done
@@ -669,11 +673,11 @@ void Parser::parseInLineStatement() {
     Token next = peekToken();
 
     if (!match(Token::Type::Identifier, next)) {
-        _globalErrorHandler.handle(19, next.lineNum());
+        syntaxError(19, next.lineNum());
     }
 
     if (isReserved(next.value())) {
-        _globalErrorHandler.handle(3, next.lineNum());
+        syntaxError(3, next.lineNum());
     }
 
     // identifier
@@ -689,7 +693,7 @@ void Parser::parseIterationStatement() {
     Token next = peekToken();
 
     if (!match(Token::Type::Identifier, next)) {
-        _globalErrorHandler.handle(20, next.lineNum());
+        syntaxError(20, next.lineNum());
     }
 
     if (next.value() == "for") {
@@ -737,7 +741,7 @@ void Parser::parseIterationStatement() {
         parseStatementOrBlock();
 
     } else {
-        _globalErrorHandler.handle(20, next.lineNum());
+        syntaxError(20, next.lineNum());
     }
 }
 
@@ -752,7 +756,7 @@ void Parser::parsePrintfStatement() {
     Token nextToken = peekToken();
     if (!match(Token::Type::DoubleQuotedString, nextToken) &&
         !match(Token::Type::SingleQuotedString, nextToken)) {
-        _globalErrorHandler.handle(21, nextToken.lineNum());
+        syntaxError(21, nextToken.lineNum());
     }
     // "string"
     Token stringToken = getToken();
@@ -781,11 +785,10 @@ void Parser::parseReturnStatement() {
     Token return_token = getToken();
 
     if (return_token.value() != "return") {
-        _globalErrorHandler.handle(22, return_token.lineNum());
+        syntaxError(22, return_token.lineNum());
     }
     addToCST(createNodePtr(return_token), LeftChild);
 
-    Token nextToken = peekToken();
     if (peekToken().type() == Token::Type::SingleQuotedString ||
         peekToken().type() == Token::Type::DoubleQuotedString) {
         addToCST(createNodePtr(getToken()), RightSibling);
@@ -796,7 +799,7 @@ void Parser::parseReturnStatement() {
     // Regardless of whether an Identifier was found, a semicolon is expected
     Token semiToken = getToken();
     if (semiToken.type() != Token::Type::Semicolon) {
-        _globalErrorHandler.handle(18, semiToken.lineNum());
+        syntaxError(18, semiToken.lineNum());
     }
     addToCST(createNodePtr(semiToken),
              RightSibling); // Adjust insertion mode as needed
@@ -808,6 +811,7 @@ NodePtr Parser::expectToken(Token::Type expectedType,
                             const std::string &errorMessage) {
     Token t = getToken();
     if (t.type() != expectedType) {
+        tokens.finish();
         cerr << errorMessage << " Found '" << Token::typeToString(t.type())
              << "' at line " << t.lineNum() << "." << endl;
         exit(100);
@@ -816,32 +820,37 @@ NodePtr Parser::expectToken(Token::Type expectedType,
     return createNodePtr(t);
 }
 
+// Reports a syntax error once the rest of the source is read, so a comment
+// error further down is still the one reported, as with a separate comment
+// pass
+void Parser::syntaxError(int errorCode, int lineNumber) {
+    tokens.finish();
+    _globalErrorHandler.handle(errorCode, lineNumber);
+}
+
 // Helper method to peek at current token without incrementing 'current'
-Token Parser::peekToken() const {
-    if (current >= tokens.size()) {
-        throw std::runtime_error(
-            "Unexpected end of input while peeking at token.");
-    }
-    return tokens[current];
+Token Parser::peekToken() {
+    return peekAhead(0);
 }
 
 // A helper method to peek ahead more than one token without incrementing
 // 'current'
-Token Parser::peekAhead(int offset) const {
-    if (current + offset >= tokens.size()) {
+Token Parser::peekAhead(int offset) {
+    const Token *token = tokens.peek(offset);
+    if (!token) {
         throw std::runtime_error(
             "Unexpected end of input while peeking at token.");
     }
-    return tokens[current + offset];
+    return *token;
 }
 
-bool isDataType(string id) {
+bool isDataType(const string &id) {
     if (id == "char" || id == "int" || id == "bool")
         return true;
     return false;
 }
 
-bool isReserved(string id) {
+bool isReserved(const string &id) {
     if (id == "char" || id == "int" || id == "bool" || id == "void" ||
         id == "function" || id == "procedure" || id == "main" ||
         id == "return" || id == "printf" || id == "getchar" || id == "if" ||
@@ -850,7 +859,7 @@ bool isReserved(string id) {
     return false;
 }
 
-bool isOperator(Token t) {
+bool isOperator(const Token &t) {
     if (t.type() == Token::Type::Plus || t.type() == Token::Type::Minus ||
         t.type() == Token::Type::Slash || t.type() == Token::Type::Asterisk ||
         t.type() == Token::Type::Modulo || t.type() == Token::Type::Caret ||
@@ -863,4 +872,4 @@ bool isOperator(Token t) {
         t.type() == Token::Type::BooleanNotEqual)
         return true;
     return false;
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -2,14 +2,16 @@
 #define PARSER_H
 
 #include "../Token/Token.h"
+#include "../Token/TokenStream.h"
 #include "../Node/Node.h" 
+#include "../Node/NodeArena.h"
 #include <vector>
 
 class Parser {
-    std::vector<Token> tokens;
-    size_t current = 0;
-    NodePtr root; // Root of the CST
-    NodePtr lastNode;
+    TokenStream &tokens; // read as the parse goes, never held in full
+    NodeArena &arena;    // owns the nodes of the CST
+    NodePtr root = nullptr; // Root of the CST
+    NodePtr lastNode = nullptr;
 
     enum InsertionMode {
         LeftChild,
@@ -18,7 +20,7 @@ class Parser {
 
 public:
     // Constructor (Using explicit to avoid accidental implicit conversions)
-    explicit Parser(const std::vector<Token>& tokens);
+    Parser(TokenStream &tokens, NodeArena &arena);
 
     NodePtr parse(); 
 
@@ -28,11 +30,12 @@ private:
     void addToCST(NodePtr node, InsertionMode mode);
     NodePtr createNodePtr(const Token& token);
 
-    Token peekToken() const;
+    Token peekToken();
     //peek ahead more than one tokens
-    Token peekAhead(int offset = 0) const;
+    Token peekAhead(int offset = 0);
 
     NodePtr expectToken(Token::Type expectedType, const std::string &errorMessage);
+    void syntaxError(int errorCode, int lineNumber);
 
 
     void parseProcedure();
@@ -62,8 +65,8 @@ private:
     void parseReturnStatement();       
 };
 
-bool isDataType(std::string id);
-bool isReserved(std::string id);
-bool isOperator(Token t);
+bool isDataType(const std::string &id);
+bool isReserved(const std::string &id);
+bool isOperator(const Token &t);
 
 #endif // PARSER_H
@@ -0,0 +1,129 @@
+#include "CompileCache.h"
+#include "../Optimizer/ASTOptimizer.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace std;
+
+CompileCache::CompileCache(string directory, size_t capacity)
+    : directory(move(directory)), capacity(capacity) {
+    if (!this->directory.empty()) {
+        error_code ignored; // without it every program just compiles again
+        filesystem::create_directories(this->directory, ignored);
+    }
+}
+
+// 64 bit FNV-1a
+uint64_t CompileCache::hash(string_view source) {
+    uint64_t value = 14695981039346656037ull;
+    for (char c : source) {
+        value ^= static_cast<unsigned char>(c);
+        value *= 1099511628211ull;
+    }
+    return value;
+}
+
+// Images are optimized at the -O level of the process that compiled them,
+// so each level has entries of its own
+string CompileCache::keyFor(ProgramImage::Kind kind, string_view source) const {
+    char key[40];
+    int length = snprintf(key, sizeof(key), "%016llx.%s",
+                          static_cast<unsigned long long>(hash(source)),
+                          kind == ProgramImage::Kind::Tree ? "tree"
+                                                           : "bytecode");
+    if (_globalOptLevel > 0)
+        snprintf(key + length, sizeof(key) - length, ".O%d", _globalOptLevel);
+    return key;
+}
+
+const string *CompileCache::find(ProgramImage::Kind kind, string_view source) {
+    string key = keyFor(kind, source);
+
+    auto found = entries.find(key);
+    if (found != entries.end()) {
+        if (found->second.source != source)
+            return nullptr;
+        recentKeys.splice(recentKeys.begin(), recentKeys, found->second.recent);
+        return &found->second.image;
+    }
+
+    string image;
+    if (readFromDisk(key, source, image))
+        return remember(key, source, move(image));
+    return nullptr;
+}
+
+void CompileCache::store(ProgramImage::Kind kind, string_view source,
+                         string image) {
+    if (!ProgramImage::isValid(image) || ProgramImage::kindOf(image) != kind)
+        return;
+    string key = keyFor(kind, source);
+    writeToDisk(key, source, image);
+    remember(key, source, move(image));
+}
+
+const string *CompileCache::remember(const string &key, string_view source,
+                                     string image) {
+    auto found = entries.find(key);
+    if (found != entries.end()) {
+        recentKeys.erase(found->second.recent);
+        entries.erase(found);
+    }
+    while (!entries.empty() && entries.size() >= capacity) {
+        entries.erase(recentKeys.back());
+        recentKeys.pop_back();
+    }
+
+    recentKeys.push_front(key);
+    Entry &entry = entries[key];
+    entry.source.assign(source);
+    entry.image = move(image);
+    entry.recent = recentKeys.begin();
+    return &entry.image;
+}
+
+// A file holds the length of the source, the source, then the image
+bool CompileCache::readFromDisk(const string &key, string_view source,
+                                string &image) const {
+    if (directory.empty())
+        return false;
+
+    ifstream file(directory + "/" + key, ios::binary);
+    uint32_t sourceSize = 0;
+    if (!file.read(reinterpret_cast<char *>(&sourceSize), sizeof(sourceSize)) ||
+        sourceSize != source.size())
+        return false;
+
+    string stored(sourceSize, '\0');
+    if (!file.read(&stored[0], sourceSize) || stored != source)
+        return false;
+
+    image.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    return ProgramImage::isValid(image);
+}
+
+// Written under a temporary name and renamed, so a reader never sees half a
+// file
+void CompileCache::writeToDisk(const string &key, string_view source,
+                               const string &image) const {
+    if (directory.empty())
+        return;
+
+    string path = directory + "/" + key;
+    string temporary = path + ".tmp" + to_string(random_device{}());
+    bool written;
+    {
+        ofstream file(temporary, ios::binary);
+        uint32_t sourceSize = static_cast<uint32_t>(source.size());
+        file.write(reinterpret_cast<const char *>(&sourceSize),
+                   sizeof(sourceSize));
+        file.write(source.data(), source.size());
+        file.write(image.data(), image.size());
+        written = static_cast<bool>(file.flush());
+    }
+    if (!written || rename(temporary.c_str(), path.c_str()) != 0)
+        remove(temporary.c_str());
+}
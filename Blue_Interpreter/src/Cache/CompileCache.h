@@ -0,0 +1,51 @@
+#ifndef COMPILECACHE_H
+#define COMPILECACHE_H
+
+#include "ProgramImage.h"
+#include <cstdint>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Program images keyed by a hash of the source they were compiled from, so
+// a program submitted again runs without being compiled again. Entries are
+// kept in memory, the least recently used dropped past 'capacity', and also
+// in 'directory' when one is given. A hit is only returned when the stored
+// source matches, a hash collision is just a miss.
+class CompileCache {
+  public:
+    explicit CompileCache(std::string directory = "", size_t capacity = 256);
+
+    // The image compiled from 'source', or nullptr. Valid until the next
+    // call to store.
+    const std::string *find(ProgramImage::Kind kind, std::string_view source);
+
+    void store(ProgramImage::Kind kind, std::string_view source,
+               std::string image);
+
+    static uint64_t hash(std::string_view source);
+
+  private:
+    struct Entry {
+        std::string source;
+        std::string image;
+        std::list<std::string>::iterator recent;
+    };
+
+    std::string keyFor(ProgramImage::Kind kind, std::string_view source) const;
+    const std::string *remember(const std::string &key, std::string_view source,
+                                std::string image);
+    bool readFromDisk(const std::string &key, std::string_view source,
+                      std::string &image) const;
+    void writeToDisk(const std::string &key, std::string_view source,
+                     const std::string &image) const;
+
+    std::string directory;
+    size_t capacity;
+
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> recentKeys; // most recently used first
+};
+
+#endif // COMPILECACHE_H
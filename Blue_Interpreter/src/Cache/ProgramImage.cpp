@@ -0,0 +1,404 @@
+#include "ProgramImage.h"
+#include "../Bytecode/BytecodeVerifier.h"
+#include "../Token/StringPool.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace ProgramImage {
+
+// Header: magic, format version, kind, total size in bytes. The version
+// changes whenever the layout below does, older images are then rejected.
+static const uint32_t Magic = 0x49554C42; // "BLUI"
+static const uint32_t Version = 5;
+static const size_t HeaderSize = 4 * sizeof(uint32_t);
+
+// Nodes and instructions are stored as arrays of fixed size records, so the
+// loader walks them in place without decoding field by field
+struct NodeRecord {
+    uint32_t type; // Token::Type
+    uint32_t text; // index into the image's strings
+    uint32_t offset;
+    uint32_t length;
+    uint32_t line;
+    uint32_t nodeType; // Node::Type
+    int32_t left;      // record index, -1 for none
+    int32_t right;
+};
+
+struct InstructionRecord {
+    uint32_t op;
+    uint32_t cond;
+    int32_t a;
+    int32_t b;
+    int32_t c;
+    int32_t line;
+};
+
+namespace {
+
+class Writer {
+  public:
+    explicit Writer(Kind kind) {
+        put(Magic);
+        put(Version);
+        put(static_cast<uint32_t>(kind));
+        put(0); // size, filled in by finish
+    }
+
+    void put(uint32_t value) {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+    void putInt(int value) { put(static_cast<uint32_t>(value)); }
+    void putString(const string &text) {
+        put(static_cast<uint32_t>(text.size()));
+        out += text;
+    }
+    template <typename Record> void putRecords(const vector<Record> &records) {
+        put(static_cast<uint32_t>(records.size()));
+        out.append(reinterpret_cast<const char *>(records.data()),
+                   records.size() * sizeof(Record));
+    }
+    void reserve(size_t size) { out.reserve(size); }
+
+    string finish() {
+        uint32_t size = static_cast<uint32_t>(out.size());
+        memcpy(&out[3 * sizeof(uint32_t)], &size, sizeof(size));
+        return move(out);
+    }
+
+  private:
+    string out;
+};
+
+class Reader {
+  public:
+    Reader(string_view image, Kind kind) : image(image) {
+        if (!isValid(image) || kindOf(image) != kind)
+            throw runtime_error("program image is damaged or out of date");
+        position = HeaderSize;
+    }
+
+    uint32_t get() {
+        uint32_t value;
+        need(sizeof(value));
+        memcpy(&value, image.data() + position, sizeof(value));
+        position += sizeof(value);
+        return value;
+    }
+    int getInt() { return static_cast<int>(get()); }
+    bool getBool() { return get() != 0; }
+    string_view getString() {
+        size_t size = get();
+        return string_view(block(size), size);
+    }
+
+    // The next 'size' bytes, read in place
+    const char *block(size_t size) {
+        need(size);
+        const char *start = image.data() + position;
+        position += size;
+        return start;
+    }
+
+    // A count followed by that many records, read in place
+    template <typename Record> const char *records(size_t &count) {
+        count = getCount(sizeof(Record));
+        return block(count * sizeof(Record));
+    }
+
+    // Number of entries that follow, each at least 'entrySize' bytes
+    size_t getCount(size_t entrySize) {
+        size_t count = get();
+        if (count > (image.size() - position) / entrySize)
+            throw runtime_error("program image ends early");
+        return count;
+    }
+
+  private:
+    void need(size_t size) {
+        if (size > image.size() - position)
+            throw runtime_error("program image ends early");
+    }
+
+    string_view image;
+    size_t position = 0;
+};
+
+} // namespace
+
+bool kindFor(const string &option, Kind &kind) {
+    if (option == "ast" || option == "symbolTable" || option == "run") {
+        kind = Kind::Tree;
+        return true;
+    }
+    if (option == "bytecode" || option == "run-vm" || option == "regcode" ||
+        option == "run-reg") {
+        kind = Kind::Bytecode;
+        return true;
+    }
+    return false;
+}
+
+bool isValid(string_view image) {
+    if (image.size() < HeaderSize)
+        return false;
+    uint32_t header[4];
+    memcpy(header, image.data(), HeaderSize);
+    return header[0] == Magic && header[1] == Version &&
+           header[2] <= static_cast<uint32_t>(Kind::Bytecode) &&
+           header[3] == image.size();
+}
+
+Kind kindOf(string_view image) {
+    uint32_t kind;
+    memcpy(&kind, image.data() + 2 * sizeof(uint32_t), sizeof(kind));
+    return static_cast<Kind>(kind);
+}
+
+// Nodes are numbered in the order they are reached from the root, token text
+// is kept once per distinct string and re-interned when loaded. The AST is a
+// tree, so every node is reached exactly once.
+string saveTree(NodePtr astRoot, const SymTblPtr &symTableRoot,
+                const vector<string> &optimizations) {
+    vector<NodeRecord> nodes;
+    vector<int> texts;
+    vector<int> textIndex(_globalStringPool.size(), -1);
+
+    // a node waiting for its index, and the record that links to it
+    struct Pending {
+        NodePtr node;
+        int parent;
+        bool isLeft;
+    };
+    vector<Pending> pending;
+    if (astRoot)
+        pending.push_back({astRoot, -1, false});
+    while (!pending.empty()) {
+        Pending next = pending.back();
+        pending.pop_back();
+
+        int index = static_cast<int>(nodes.size());
+        if (next.parent >= 0)
+            (next.isLeft ? nodes[next.parent].left
+                         : nodes[next.parent].right) = index;
+
+        const Token &token = next.node->value;
+        int &text = textIndex[token.id()];
+        if (text < 0) {
+            text = static_cast<int>(texts.size());
+            texts.push_back(token.id());
+        }
+
+        nodes.push_back({static_cast<uint32_t>(token.type()),
+                         static_cast<uint32_t>(text),
+                         static_cast<uint32_t>(token.offset()),
+                         static_cast<uint32_t>(token.length()),
+                         static_cast<uint32_t>(token.lineNum()),
+                         static_cast<uint32_t>(next.node->nodeType), -1, -1});
+
+        if (next.node->leftChild)
+            pending.push_back({next.node->leftChild, index, true});
+        if (next.node->rightSibling)
+            pending.push_back({next.node->rightSibling, index, false});
+    }
+
+    Writer out(Kind::Tree);
+    out.reserve(HeaderSize + nodes.size() * sizeof(NodeRecord) +
+                texts.size() * 2 * sizeof(uint32_t) + 1024);
+
+    out.put(static_cast<uint32_t>(texts.size()));
+    for (int id : texts)
+        out.putString(_globalStringPool.get(id));
+
+    vector<SymTblPtr> tables;
+    for (SymTblPtr table = symTableRoot; table; table = table->GetNextTable())
+        tables.push_back(table);
+    out.put(static_cast<uint32_t>(tables.size()));
+    for (const SymTblPtr &table : tables) {
+        out.putString(table->GetName());
+        out.putString(table->GetDataType());
+        out.put(static_cast<uint32_t>(table->GetIdType()));
+        out.putInt(table->GetScope());
+        out.put(table->isArray());
+        out.putInt(table->GetArraySize());
+        out.putString(table->procOrFuncName());
+    }
+
+    out.put(static_cast<uint32_t>(optimizations.size()));
+    for (const string &change : optimizations)
+        out.putString(change);
+
+    out.putRecords(nodes);
+
+    return out.finish();
+}
+
+// Nodes are created in the arena straight from the records, the only
+// allocations are the arena's chunks and one table of node addresses
+NodePtr loadTree(string_view image, NodeArena &arena,
+                 SymTblPtr &symTableRoot, vector<string> &optimizations) {
+    Reader in(image, Kind::Tree);
+
+    vector<int> ids(in.getCount(sizeof(uint32_t)));
+    for (int &id : ids) {
+        string_view text = in.getString();
+        id = _globalStringPool.intern(text.data(), text.size());
+    }
+
+    symTableRoot = nullptr;
+    SymTblPtr last = nullptr;
+    for (size_t count = in.getCount(7 * sizeof(uint32_t)); count > 0;
+         --count) {
+        string name(in.getString());
+        string dataType(in.getString());
+        uint32_t idType = in.get();
+        if (idType > static_cast<uint32_t>(SymbolTable::IDType::parameterList))
+            throw runtime_error("program image has an unknown symbol kind");
+        int scope = in.getInt();
+        bool isArray = in.getBool();
+        int arraySize = in.getInt();
+        string owner(in.getString());
+        if (arraySize < 0)
+            throw runtime_error("program image has a negative array size");
+
+        auto table = make_shared<SymbolTable>(
+            name, dataType, static_cast<SymbolTable::IDType>(idType), scope,
+            isArray, arraySize, owner);
+        if (last)
+            last->SetNextTable(table);
+        else
+            symTableRoot = table;
+        last = table;
+    }
+
+    optimizations.clear();
+    for (size_t count = in.getCount(sizeof(uint32_t)); count > 0; --count)
+        optimizations.emplace_back(in.getString());
+
+    size_t count;
+    const char *records = in.records<NodeRecord>(count);
+    auto record = [records](size_t index) {
+        NodeRecord node;
+        memcpy(&node, records + index * sizeof(NodeRecord), sizeof(node));
+        return node;
+    };
+
+    // links may point forward, so every node exists before any is linked
+    vector<NodePtr> nodes(count);
+    for (size_t i = 0; i < count; ++i) {
+        NodeRecord node = record(i);
+        if (node.text >= ids.size())
+            throw runtime_error("program image has an index out of range");
+        if (node.type > static_cast<uint32_t>(Token::Type::Unknown) ||
+            node.nodeType > static_cast<uint32_t>(Node::Type::OTHER))
+            throw runtime_error("program image has an unknown node type");
+        nodes[i] = arena.create(Token(static_cast<Token::Type>(node.type),
+                                      ids[node.text], node.offset,
+                                      node.length, node.line),
+                                static_cast<Node::Type>(node.nodeType));
+    }
+    // every node but the root is linked to exactly once, so the links form
+    // a tree and the stages walking it can't loop or see a node twice
+    vector<bool> linked(count, false);
+    auto link = [&](int32_t index) -> NodePtr {
+        if (index < -1 || index >= static_cast<int64_t>(count))
+            throw runtime_error("program image has an index out of range");
+        if (index < 0)
+            return nullptr;
+        if (index == 0 || linked[index])
+            throw runtime_error("program image links a node twice");
+        linked[index] = true;
+        return nodes[index];
+    };
+    for (size_t i = 0; i < count; ++i) {
+        NodeRecord node = record(i);
+        nodes[i]->leftChild = link(node.left);
+        nodes[i]->rightSibling = link(node.right);
+    }
+
+    return nodes.empty() ? nullptr : nodes[0];
+}
+
+string saveBytecode(const BytecodeProgram &program) {
+    Writer out(Kind::Bytecode);
+
+    out.putInt(program.numGlobals);
+
+    vector<InstructionRecord> code;
+    code.reserve(program.code.size());
+    for (size_t i = 0; i < program.code.size(); ++i) {
+        const Instruction &instruction = program.code[i];
+        code.push_back({static_cast<uint32_t>(instruction.op),
+                        static_cast<uint32_t>(instruction.cond), instruction.a,
+                        instruction.b, instruction.c, program.lines[i]});
+    }
+    out.putRecords(code);
+
+    out.put(static_cast<uint32_t>(program.strings.size()));
+    for (const string &text : program.strings)
+        out.putString(text);
+
+    out.put(static_cast<uint32_t>(program.functions.size()));
+    for (const FunctionInfo &function : program.functions) {
+        out.putString(function.name);
+        out.putInt(function.entry);
+        out.putInt(function.frameSize);
+        out.put(function.returnsValue);
+        out.put(static_cast<uint32_t>(function.paramOffsets.size()));
+        for (int offset : function.paramOffsets)
+            out.putInt(offset);
+    }
+
+    return out.finish();
+}
+
+BytecodeProgram loadBytecode(string_view image) {
+    Reader in(image, Kind::Bytecode);
+    BytecodeProgram program;
+
+    program.numGlobals = in.getInt();
+
+    size_t count;
+    const char *code = in.records<InstructionRecord>(count);
+    program.code.reserve(count);
+    program.lines.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        InstructionRecord instruction;
+        memcpy(&instruction, code + i * sizeof(instruction),
+               sizeof(instruction));
+        if (instruction.op >= static_cast<uint32_t>(OpCodeCount) ||
+            instruction.cond >= static_cast<uint32_t>(OpCodeCount))
+            throw runtime_error("program image has an unknown opcode");
+        int index =
+            program.emit(static_cast<OpCode>(instruction.op), instruction.a,
+                         instruction.b, instruction.line);
+        program.code[index].cond = static_cast<OpCode>(instruction.cond);
+        program.code[index].c = instruction.c;
+    }
+
+    for (count = in.getCount(sizeof(uint32_t)); count > 0; --count)
+        program.strings.emplace_back(in.getString());
+
+    for (count = in.getCount(5 * sizeof(uint32_t)); count > 0; --count) {
+        FunctionInfo function;
+        function.name = in.getString();
+        function.entry = in.getInt();
+        function.frameSize = in.getInt();
+        function.returnsValue = in.getBool();
+        for (size_t params = in.getCount(sizeof(uint32_t)); params > 0;
+             --params)
+            function.paramOffsets.push_back(in.getInt());
+        program.functions.push_back(move(function));
+    }
+
+    // the VMs trust their code, an image may have been damaged or edited
+    verifyBytecode(program);
+    return program;
+}
+
+} // namespace ProgramImage
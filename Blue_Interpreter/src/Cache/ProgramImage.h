@@ -0,0 +1,46 @@
+#ifndef PROGRAMIMAGE_H
+#define PROGRAMIMAGE_H
+
+#include "../Bytecode/Bytecode.h"
+#include "../Node/NodeArena.h"
+#include "../SymbolTable/SymbolTable.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A compiled program flattened into bytes, so it can be kept and run again
+// without any of the stages that built it. A tree image holds the AST, the
+// symbol tables and what the optimizer changed, which is all the ast,
+// symbolTable and run options need. A bytecode image holds the
+// BytecodeProgram for bytecode and run-vm.
+//
+// Images start with a format version and are rejected by a build that writes
+// another one. Integers are stored in the byte order of the machine that
+// wrote them.
+namespace ProgramImage {
+
+enum class Kind : uint32_t { Tree, Bytecode };
+
+// The kind of image 'option' can run from, false if it needs the source
+bool kindFor(const std::string &option, Kind &kind);
+
+std::string saveTree(NodePtr astRoot, const SymTblPtr &symTableRoot,
+                     const std::vector<std::string> &optimizations);
+std::string saveBytecode(const BytecodeProgram &program);
+
+// True if 'image' is complete and in the format this build writes
+bool isValid(std::string_view image);
+Kind kindOf(std::string_view image);
+
+// Rebuild what was saved, with the nodes created in 'arena'. Both throw
+// runtime_error if the image is damaged, bytecode is checked by
+// verifyBytecode so the VMs can run it as they would the compiler's.
+NodePtr loadTree(std::string_view image, NodeArena &arena,
+                 SymTblPtr &symTableRoot,
+                 std::vector<std::string> &optimizations);
+BytecodeProgram loadBytecode(std::string_view image);
+
+} // namespace ProgramImage
+
+#endif // PROGRAMIMAGE_H
@@ -0,0 +1,133 @@
+#include "CommentFilter.h"
+#include <stdexcept>
+
+// Same transitions and errors as fileAsArray::File_w_no_comments, one
+// character per call
+void CommentFilter::step() {
+    size_t i = next++;
+    blanked &= ~(uint64_t(1) << (i % 64));
+    char c = source[i];
+
+    if (c == '\n')
+        lineNumber++;
+
+    switch (state) {
+    case fileAsArray::START:
+        if (c == '\'') {
+            errorLineNumber = lineNumber;
+            state = fileAsArray::SINGLE_QUOTE;
+        } else if (c == '"') {
+            errorLineNumber = lineNumber;
+            state = fileAsArray::DOUBLE_QUOTE;
+        } else if (c == '/') {
+            errorLineNumber = lineNumber;
+            std::pair<bool, size_t> result = isDivision(i);
+            if (result.first) {
+                skipTo(result.second + 1); // the operand is left as is
+            } else {
+                blank(i);
+                state = fileAsArray::SLASH;
+            }
+        } else if (c == '*') {
+            std::pair<bool, size_t> result = isMultiplication(i);
+            if (result.first) {
+                skipTo(result.second);
+            } else {
+                throw std::runtime_error("ERROR: Program contains C-style, "
+                                         "Block comment not started on line " +
+                                         std::to_string(lineNumber));
+            }
+        }
+        break;
+
+    case fileAsArray::SLASH:
+        if (c == '/') {
+            state = fileAsArray::LINE_COMMENT;
+            blank(i);
+        } else if (c == '*') {
+            state = fileAsArray::BLOCK_COMMENT;
+            blank(i);
+        } else {
+            throw std::runtime_error("ERROR: Program contains C-style, "
+                                     "incomplete line comment on line " +
+                                     std::to_string(errorLineNumber));
+        }
+        break;
+
+    case fileAsArray::LINE_COMMENT:
+        if (c == '\n')
+            state = fileAsArray::START;
+        else
+            blank(i);
+        break;
+
+    case fileAsArray::BLOCK_COMMENT:
+        if (c == '*')
+            state = fileAsArray::ENDING_BLOCK_COMMENT;
+        blank(i); // newlines too, as File_w_no_comments does
+        break;
+
+    case fileAsArray::ENDING_BLOCK_COMMENT:
+        if (c == '/') {
+            state = fileAsArray::START;
+            blank(i);
+        } else if (c != '\n') {
+            blank(i);
+        }
+        break;
+
+    case fileAsArray::SINGLE_QUOTE:
+        if (c == '\'')
+            state = fileAsArray::START;
+        break;
+
+    case fileAsArray::DOUBLE_QUOTE:
+        if (c == '"')
+            state = fileAsArray::START;
+        break;
+    }
+}
+
+// Continues the scan at 'index', the characters skipped are kept
+void CommentFilter::skipTo(size_t index) {
+    if (index - next >= 64)
+        blanked = 0;
+    for (; next < index; ++next)
+        blanked &= ~(uint64_t(1) << (next % 64));
+}
+
+void CommentFilter::finish() {
+    while (next < source.size())
+        step();
+
+    if (state != fileAsArray::START) {
+        throw std::runtime_error("ERROR: Program contains C-style, incomplete "
+                                 "block comment on line " +
+                                 std::to_string(errorLineNumber));
+    }
+}
+
+// Index of the first character after the '/' that isn't a space, and whether
+// that makes the '/' a division
+std::pair<bool, size_t> CommentFilter::isDivision(size_t index) const {
+    while (++index < source.size()) {
+        if (isspace(source[index]))
+            continue;
+        return std::make_pair(isdigit(source[index]) || isalpha(source[index]) ||
+                                  source[index] == '(',
+                              index);
+    }
+    return std::make_pair(false, index);
+}
+
+// Index just past the operand following the '*', and whether there is one
+std::pair<bool, size_t> CommentFilter::isMultiplication(size_t index) const {
+    index++;
+    while (index < source.size() && isspace(source[index]))
+        index++;
+    if (index < source.size() &&
+        (isdigit(source[index]) || isalpha(source[index]) ||
+         source[index] == '('))
+        return std::make_pair(true, index + 1);
+    return std::make_pair(false, index);
+}
@@ -0,0 +1,44 @@
+#ifndef COMMENTFILTER_H
+#define COMMENTFILTER_H
+
+#include "fileAsArray.h"
+#include <cstdint>
+#include <string_view>
+
+// The comment removal DFA of fileAsArray::File_w_no_comments run lazily over
+// the unmodified source. The Tokenizer asks for one character at a time, so
+// comments are stripped in the same pass that finds the tokens and no copy
+// of the source is written.
+class CommentFilter {
+  public:
+    explicit CommentFilter(std::string_view source) : source(source) {}
+
+    // Character at 'index' once comments are replaced by spaces. Only the
+    // last 64 characters are remembered, so indices may move back just a few
+    // places.
+    char at(size_t index) {
+        while (next <= index)
+            step();
+        return (blanked >> (index % 64)) & 1 ? ' ' : source[index];
+    }
+
+    // Runs to the end of the source, throws if a comment is left open
+    void finish();
+
+  private:
+    void step();
+    void blank(size_t index) { blanked |= uint64_t(1) << (index % 64); }
+    void skipTo(size_t index);
+
+    std::pair<bool, size_t> isDivision(size_t index) const;
+    std::pair<bool, size_t> isMultiplication(size_t index) const;
+
+    std::string_view source;
+    fileAsArray::State state = fileAsArray::START;
+    size_t next = 0;      // first index the DFA has not seen yet
+    uint64_t blanked = 0; // one bit per index, set if it was replaced
+    int lineNumber = 1;
+    int errorLineNumber = 1;
+};
+
+#endif // COMMENTFILTER_H
@@ -1,24 +1,87 @@
 #include "fileAsArray.h"
 #include "../ErrorHandler/ErrorHandler.h"
 
+#if defined(__unix__) || defined(__APPLE__)
+#define FILEASARRAY_MMAP
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 fileAsArray::fileAsArray(std::string fileName) {
-    inputStream.open(fileName, std::ios::in);
     inputFileName = fileName;
     errorLineNumber = 1;
 }
 
+fileAsArray::~fileAsArray() {
+#ifdef FILEASARRAY_MMAP
+    if (mapping)
+        munmap(mapping, sourceSize);
+#endif
+}
+
 void fileAsArray::readFile() {
+#ifdef FILEASARRAY_MMAP
+    int fd = open(inputFileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        _globalErrorHandler.handle(1, errorLineNumber);
+    }
+    // Pipes, FIFOs and devices can't be mapped and have no size up front,
+    // so they are read until the end from the same descriptor
+    if (!mapFile(fd)) {
+        char chunk[ReadChunk];
+        ssize_t count;
+        while ((count = read(fd, chunk, sizeof chunk)) != 0) {
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count < 0) {
+                close(fd);
+                _globalErrorHandler.handle(1, errorLineNumber);
+            }
+            buffer.insert(buffer.end(), chunk, chunk + count);
+        }
+    }
+    close(fd);
+    if (mapping)
+        return;
+#else
+    std::ifstream inputStream(inputFileName, std::ios::in);
     if (!inputStream.is_open()) {
         _globalErrorHandler.handle(1, errorLineNumber);
     }
-    char c;
+    char chunk[ReadChunk];
+    while (inputStream.read(chunk, sizeof chunk) || inputStream.gcount() > 0)
+        buffer.insert(buffer.end(), chunk, chunk + inputStream.gcount());
+#endif
 
-    while (inputStream.get(c) && !inputStream.eof()) {
-        // std::cout << c;
-        file.push_back(c);
+    source = buffer.data();
+    sourceSize = buffer.size();
+}
+
+void fileAsArray::readSource(std::string_view text) {
+    source = text.data();
+    sourceSize = text.size();
+}
+
+#ifdef FILEASARRAY_MMAP
+// Maps a regular file read only. Returns false if it can't be mapped, empty
+// files included, so readFile can read it instead.
+bool fileAsArray::mapFile(int fd) {
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void *address =
+            mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            mapping = address;
+            source = static_cast<const char *>(address);
+            sourceSize = info.st_size;
+        }
     }
-    inputStream.close();
+    return mapping != nullptr;
 }
+#endif
 
 /*
  Mutates the original vector stored as a private variable 'file'
@@ -26,6 +89,9 @@ void fileAsArray::readFile() {
  within the class 'fileAsArray'
  */
 void fileAsArray::File_w_no_comments() {
+    // Comments are blanked in a single output buffer, the source stays as is
+    file.assign(source, source + sourceSize);
+
     State state =
         START; // Initialize the state to START (Also the accepting state)
     int lineNumber = 1; // Keeps track of line number during parsing
@@ -193,8 +259,7 @@ std::pair<bool, int> fileAsArray::isMultiplication(int index) {
 std::pair<bool, int> fileAsArray::isDivision(int index) {
     size_t length = file.size();
     // Iterate through each character in the file
-    while (index < length) {
-        index++;
+    while (++index < length) {
         // If a space then continue looping
         if (isspace(file[index])) {
             continue;
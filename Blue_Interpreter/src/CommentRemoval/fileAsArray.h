@@ -4,6 +4,7 @@
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 /// Preliminary for removing comments and storing into vector of chars
@@ -21,9 +22,19 @@ class fileAsArray {
     };
 
     fileAsArray(std::string fileName);
+    ~fileAsArray();
 
+    fileAsArray(const fileAsArray &) = delete;
+    fileAsArray &operator=(const fileAsArray &) = delete;
+
+    // Maps the file into memory, or reads it until the end where it can't
+    // be mapped (pipes, FIFOs, other platforms). The source itself is never modified.
     void readFile();
 
+    // Takes the source from memory instead, for programs that never touch
+    // the disk. Nothing is copied, 'text' must outlive this object.
+    void readSource(std::string_view text);
+
     void File_w_no_comments(); // Parses the vector of chars to remove comments
 
     // Returns the index following the Division Op. and if it was div.
@@ -32,16 +43,31 @@ class fileAsArray {
     // Returns the index following the Division Op. and if it was div.
     std::pair<bool, int> isMultiplication(int index);
 
-    // Method to get a reference to the vector in the main
-    const std::vector<char> &getFileContent() const { return file; }
+    // The file as read, comments included
+    std::string_view getSource() const {
+        return std::string_view(source, sourceSize);
+    }
+
+    // View of the source with comments removed, valid while this object is
+    std::string_view getFileContent() const {
+        return std::string_view(file.data(), file.size());
+    }
 
     void printVector();
 
   private:
-    std::vector<char> file;
+    static const size_t ReadChunk = 64 * 1024;
+
+    bool mapFile(int fd);
+
+    const char *source = nullptr; // the file as read, mapped or in 'buffer'
+    size_t sourceSize = 0;
+    void *mapping = nullptr;
+    std::vector<char> buffer;
+
+    std::vector<char> file; // output of the comment removal
     int errorLineNumber; // Keeps track of line number during parsing when error
                          // found
-    std::ifstream inputStream;
     std::string inputFileName;
 };
 
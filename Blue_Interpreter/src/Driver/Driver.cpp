@@ -0,0 +1,275 @@
+#include "Driver.h"
+#include "../AST/ASTParser.h"
+#include "../Bytecode/BytecodeCompiler.h"
+#include "../Bytecode/RegisterTranslator.h"
+#include "../CST/Parser.h"
+#include "../Interpreter/Interpreter.h"
+#include "../Node/Node.h"
+#include "../Node/NodeArena.h"
+#include "../Optimizer/ASTOptimizer.h"
+#include "../Output/OutputSink.h"
+#include "../OutputGenerator/OutPutGenerator.h"
+#include "../SymbolTable/SymbolResolver.h"
+#include "../SymbolTable/SymbolTablesLinkedList.h"
+#include "../Token/Token.h"
+#include "../Token/TokenStream.h"
+#include "../Token/Tokenizer.h"
+#include "../VM/RegisterMachine.h"
+#include "../VM/VirtualMachine.h"
+
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+// Whether the option works on the compiled bytecode
+static bool isBytecodeOption(const string &option) {
+    return option == "bytecode" || option == "run-vm" ||
+           option == "regcode" || option == "run-reg";
+}
+
+// Errors thrown once the tree is built, such as a name with no symbol table,
+// are reported like the ones before it, after what the program printed
+static int reportError(const std::exception &error) {
+    _globalOutput.flush();
+    cerr << "Exception caught: " << error.what() << endl;
+    return 1;
+}
+
+// Every stage after the bytecode is compiled
+static int runBytecode(const BytecodeProgram &program, const string &option) {
+    if (option == "bytecode") {
+        OutPutGenerator BCOutput;
+        BCOutput.PrintBytecode(program);
+        return 0;
+    }
+
+    // regcode and run-reg translate the stack code into register form
+    RegisterProgram registers;
+    if (option == "regcode" || option == "run-reg")
+        registers = RegisterTranslator(program).translate();
+
+    if (option == "regcode") {
+        OutPutGenerator RCOutput;
+        RCOutput.PrintRegisterCode(registers);
+        return 0;
+    }
+
+    try {
+        if (option == "run-reg") {
+            RegisterMachine machine(registers);
+            machine.run();
+        } else {
+            VirtualMachine vm(program);
+            vm.run();
+        }
+    } catch (const std::exception &error) {
+        return reportError(error);
+    }
+    return 0;
+}
+
+// Every stage after the AST and symbol tables are built, shared by programs
+// compiled from source and ones loaded from an image. 'optimizations' is
+// what the optimizer changed, tree images keep it so the dumps of a cached
+// program are the same as the first time.
+static int runTree(NodePtr astRoot, SymTblPtr symTableRoot,
+                   const string &option, const ImageSink &compiled,
+                   const vector<string> &optimizations) {
+    ProgramImage::Kind kind;
+    bool saving = compiled && ProgramImage::kindFor(option, kind);
+    if (saving && kind == ProgramImage::Kind::Tree)
+        compiled(ProgramImage::saveTree(astRoot, symTableRoot, optimizations));
+
+    if (option == "symbolTable") {
+        OutPutGenerator STOutput;
+        STOutput.PrintSymbolTables(symTableRoot);
+        if (_globalOptLevel > 0)
+            STOutput.PrintOptimizations(_globalOptLevel, optimizations);
+        return 0;
+    }
+
+    if (option == "ast") {
+        OutPutGenerator ASOutput;
+        ASOutput.PrintAST(astRoot);
+        if (_globalOptLevel > 0)
+            ASOutput.PrintOptimizations(_globalOptLevel, optimizations);
+        return 0;
+    }
+
+    BytecodeProgram program;
+    try {
+        // bind every identifier in the AST to its storage slot
+        SymbolResolver resolver(symTableRoot);
+        resolver.resolve(astRoot);
+
+        if (option == "run")
+            Interpreter interpret(astRoot, symTableRoot, resolver);
+
+        if (!isBytecodeOption(option))
+            return 0;
+        BytecodeCompiler compiler(astRoot, resolver);
+        program = compiler.compile();
+    } catch (const std::exception &error) {
+        return reportError(error);
+    }
+
+    if (saving && kind == ProgramImage::Kind::Bytecode)
+        compiled(ProgramImage::saveBytecode(program));
+    return runBytecode(program, option);
+}
+
+int runSource(string_view source, const string &option, bool fusedLexer,
+              const ImageSink &compiled) {
+    fileAsArray sourceFile("<memory>");
+    sourceFile.readSource(source);
+    return runProgram(sourceFile, option, fusedLexer, compiled);
+}
+
+int runImage(string_view image, const string &option) {
+    NodeArena arena;
+    SymTblPtr symTableRoot = nullptr;
+    NodePtr astRoot = nullptr;
+    vector<string> optimizations;
+    BytecodeProgram program;
+    bool bytecode = ProgramImage::isValid(image) &&
+                    ProgramImage::kindOf(image) == ProgramImage::Kind::Bytecode;
+
+    try {
+        if (bytecode) {
+            if (!isBytecodeOption(option))
+                throw runtime_error("a bytecode image can't run with " +
+                                    option);
+            program = ProgramImage::loadBytecode(image);
+        } else {
+            astRoot = ProgramImage::loadTree(image, arena, symTableRoot,
+                                             optimizations);
+        }
+    } catch (const std::exception &error) {
+        cerr << "Exception caught: " << error.what() << endl;
+        return 1;
+    }
+
+    if (bytecode)
+        return runBytecode(program, option);
+    return runTree(astRoot, symTableRoot, option, nullptr, optimizations);
+}
+
+int runCached(fileAsArray &sourceFile, const string &option, bool fusedLexer,
+              CompileCache &cache) {
+    ProgramImage::Kind kind;
+    if (!ProgramImage::kindFor(option, kind))
+        return runProgram(sourceFile, option, fusedLexer);
+
+    string_view source = sourceFile.getSource();
+    if (const string *image = cache.find(kind, source))
+        return runImage(*image, option);
+
+    return runProgram(sourceFile, option, fusedLexer,
+                      [&](const string &image) {
+                          cache.store(kind, source, image);
+                      });
+}
+
+// Runs every stage up to and including the AST and its optimization.
+// Returns -1 once the AST is built, otherwise the exit code of an option
+// that stops before it.
+static int buildTree(fileAsArray &sourceFile, const string &option,
+                     bool fusedLexer, NodeArena &arena, NodePtr &astRoot,
+                     SymTblPtr &symTableRoot, vector<string> &optimizations) {
+    NodePtr cstRoot = nullptr;
+
+    // the parser pulls tokens as it goes, so comment errors can surface
+    // while parsing
+    try {
+        if (!fusedLexer)
+            sourceFile.File_w_no_comments();
+
+        Tokenizer tokenizer(fusedLexer ? sourceFile.getSource()
+                                       : sourceFile.getFileContent(),
+                            fusedLexer);
+
+        if (option == "tokens") {
+            tokenizer.tokenizeVector();
+            for (const auto &token : tokenizer.getTokens()) {
+                token.print();
+            }
+            return 0;
+        }
+
+        TokenStream tokens(tokenizer);
+        Parser parser(tokens, arena);
+        cstRoot = parser.parse();
+    } catch (const std::exception &error) {
+        cerr << "Exception caught: " << error.what() << endl;
+        return 1;
+    }
+
+    if (option == "cst") {
+        OutPutGenerator CSToutput;
+        CSToutput.PrintCST(cstRoot);
+        return 0;
+    }
+
+    SymbolTablesLinkedList tables(cstRoot);
+    symTableRoot = tables.parse();
+
+    ASTParser astParser(cstRoot, arena);
+    astRoot = astParser.parse();
+
+    ASTOptimizer optimizer(arena, symTableRoot, _globalOptLevel);
+    optimizer.optimize(astRoot);
+    optimizations = optimizer.report();
+    return -1;
+}
+
+int runProgram(fileAsArray &sourceFile, const string &option, bool fusedLexer,
+               const ImageSink &compiled) {
+    // owns every CST and AST node until the program exits
+    NodeArena arena;
+    NodePtr astRoot = nullptr;
+    SymTblPtr symTableRoot = nullptr;
+    vector<string> optimizations;
+
+    int status = buildTree(sourceFile, option, fusedLexer, arena, astRoot,
+                           symTableRoot, optimizations);
+    if (status >= 0)
+        return status;
+    return runTree(astRoot, symTableRoot, option, compiled, optimizations);
+}
+
+int compileProgram(fileAsArray &sourceFile, ProgramImage::Kind kind,
+                   bool fusedLexer, const ImageSink &compiled) {
+    NodeArena arena;
+    NodePtr astRoot = nullptr;
+    SymTblPtr symTableRoot = nullptr;
+
+    vector<string> optimizations;
+    int status = buildTree(sourceFile, "compile", fusedLexer, arena, astRoot,
+                           symTableRoot, optimizations);
+    if (status >= 0)
+        return status;
+
+    if (kind == ProgramImage::Kind::Tree) {
+        compiled(ProgramImage::saveTree(astRoot, symTableRoot, optimizations));
+        return 0;
+    }
+
+    BytecodeProgram program;
+    try {
+        SymbolResolver resolver(symTableRoot);
+        resolver.resolve(astRoot);
+        BytecodeCompiler compiler(astRoot, resolver);
+        program = compiler.compile();
+    } catch (const std::exception &error) {
+        return reportError(error);
+    }
+    compiled(ProgramImage::saveBytecode(program));
+    return 0;
+}
+
+int execImage(string_view image) {
+    bool bytecode = ProgramImage::isValid(image) &&
+                    ProgramImage::kindOf(image) == ProgramImage::Kind::Bytecode;
+    return runImage(image, bytecode ? "run-vm" : "run");
+}
@@ -0,0 +1,46 @@
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include "../Cache/CompileCache.h"
+#include "../CommentRemoval/fileAsArray.h"
+#include <functional>
+#include <string>
+#include <string_view>
+
+// Entry points for hosts linking the BlueInterpreter library. Output goes to
+// std::cout and std::cerr the same way the command line prints it, except
+// what the program itself prints, which goes to _globalOutput and can be
+// sent to another FILE or captured into a string there. Programs run under
+// _globalLimits.
+
+// Given the image of a program once it is compiled, before it runs
+using ImageSink = std::function<void(const std::string &image)>;
+
+// Runs every stage up to the one 'option' asks for on a source that has
+// already been read, printing its output. Returns the process exit code.
+// 'compiled' is only called for options ProgramImage::kindFor accepts.
+int runProgram(fileAsArray &sourceFile, const std::string &option,
+               bool fusedLexer = false, const ImageSink &compiled = nullptr);
+
+// The same for a program held in memory, nothing is written or read from
+// disk
+int runSource(std::string_view source, const std::string &option,
+              bool fusedLexer = false, const ImageSink &compiled = nullptr);
+
+// Compiles without running and hands the image to 'compiled'. Returns the
+// process exit code.
+int compileProgram(fileAsArray &sourceFile, ProgramImage::Kind kind,
+                   bool fusedLexer, const ImageSink &compiled);
+
+// Runs a program from an image, skipping every stage before execution
+int runImage(std::string_view image, const std::string &option);
+
+// Executes an image, with the tree-walker or the VM depending on its kind
+int execImage(std::string_view image);
+
+// Runs the image in 'cache' if the program was compiled before, otherwise
+// compiles it and adds its image
+int runCached(fileAsArray &sourceFile, const std::string &option,
+              bool fusedLexer, CompileCache &cache);
+
+#endif // DRIVER_H
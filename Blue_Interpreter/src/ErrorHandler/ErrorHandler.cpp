@@ -1,4 +1,5 @@
 #include "ErrorHandler.h"
+#include "../Output/OutputSink.h"
 #include <functional>
 #include <iostream>
 #include <string>
@@ -9,6 +10,8 @@ ErrorHandler _globalErrorHandler;
 
 // Maps the error code to those initialized
 void ErrorHandler::handle(int errorCode, int lineNumber, const std::string& message1, const std::string& message2) {
+    // what the program printed so far comes before the error
+    _globalOutput.flush();
     if (errorHandlers.find(errorCode) != errorHandlers.end()) {
         errorHandlers[errorCode](lineNumber, message1, message2);
     } else {
@@ -183,4 +186,12 @@ void ErrorHandler::initializeErrorHandlers() {
         logError(line, "Error 38: Expected array access", msg1, msg2);
         exit(38);
     };
+    errorHandlers[39] = [this](int line, const std::string& msg1, const std::string& msg2) {
+        logError(line, "Error 39: Array index out of bounds", msg1, msg2);
+        exit(39);
+    };
+    errorHandlers[40] = [this](int line, const std::string& msg1, const std::string& msg2) {
+        logError(line, "Error 40: Execution limit exceeded", msg1, msg2);
+        exit(40);
+    };
 }
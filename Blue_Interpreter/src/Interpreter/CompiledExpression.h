@@ -0,0 +1,36 @@
+#ifndef COMPILEDEXPRESSION_H
+#define COMPILEDEXPRESSION_H
+
+#include "../Node/Node.h"
+#include "../Token/Token.h"
+#include <vector>
+
+struct FunctionEntry;
+
+// One pre-decoded step of a postfix expression
+struct ExpressionOp {
+    enum class Kind {
+        PUSH,         // push 'value'
+        LOAD,         // push the variable bound to 'node'
+        LOAD_ELEMENT, // pop an index, push that element of 'node'
+        CALL,         // call 'callee' with the arguments starting at 'node'
+        NOT,
+        BINARY, // apply 'op' to the top two values
+        FAIL,   // raise error 'value' on the line of 'node'
+    };
+
+    Kind kind;
+    int value = 0;
+    Token::Type op = Token::Type::Unknown;
+    const FunctionEntry *callee = nullptr;
+    NodePtr node = nullptr;
+};
+
+// A postfix expression compiled once from its AST sibling chain, cached on
+// the first node of the chain
+struct CompiledExpression {
+    bool inAssignment = false;
+    std::vector<ExpressionOp> ops;
+};
+
+#endif // COMPILEDEXPRESSION_H
@@ -14,52 +14,146 @@
 #define debug 0 && std::cout
 #endif
 
-Interpreter::Interpreter(const NodePtr &astRoot, const SymTblPtr &symTblRoot) {
+Interpreter::Interpreter(const NodePtr &astRoot, const SymTblPtr &symTblRoot,
+                         const SymbolResolver &resolver, OutputSink &output,
+                         const ExecutionLimits &limits)
+    : resolver(resolver), output(output), limits(limits) {
+    char here;
+    stackBase = reinterpret_cast<uintptr_t>(&here);
+
     // rootTable = symTblRoot;
     this->rootTable = symTblRoot;
     this->astRoot = astRoot;
     scopeStack.push(0);
 
+    globals.resize(resolver.frame(0).size, 0);
+
+    buildFunctionDirectory();
+    buildControlFlow();
+
     // locate main in AST
-    this->PC = findFunctOrProcStart("main");
+    const FunctionEntry &mainEntry =
+        findFunction(_globalStringPool.intern("main"));
+    this->PC = mainEntry.entry;
     debug << "MAIN FOUND AT LINE NUM: " << this->PC->Value().lineNum() << endl;
-    scopeStack.push(getSymbolTable("main", 0, true)->GetScope());
+    scopeStack.push(mainEntry.scope);
+
+    // main runs in the first activation record
+    locals.resize(resolver.frame(mainEntry.scope).size, 0);
+    frameBases.push_back(0);
 
     PC = peekNext(PC);
     // start execution of program
 
-    while (PC != nullptr) {
+    while (PC != nullptr && !returning) {
         iteratePC();
     }
+    output.flush();
 
     debug << "Finished Execution" << endl;
 }
 
-void Interpreter::executeDeclaration(string variable, int scope) {
+// Bytes of program values and of the native stack taken by the calls it
+// made, what the memory limit is compared against
+size_t Interpreter::memoryInUse() const {
+    return (globals.size() + locals.size() + operands.size() +
+            frameBases.size()) *
+               sizeof(int) +
+           stackInUse();
+}
 
-    if (scope == -1)
-        scope = scopeStack.top();
+// Bytes of native stack taken since execution began
+size_t Interpreter::stackInUse() const {
+    char here;
+    uintptr_t top = reinterpret_cast<uintptr_t>(&here);
+    return top < stackBase ? stackBase - top : top - stackBase;
+}
 
+// Storage of the variable an identifier node was bound to by the resolver
+int &Interpreter::variable(const NodePtr &node, int index /*default 0*/) {
+    if (!node->binding) {
+        throw std::runtime_error("No Symbol Table for " + node->Value().value());
+    }
+    return storage(*node->binding, index);
+}
 
-    SymTblPtr currTable = rootTable;
-    while (currTable->GetName() != variable || (currTable->GetScope() != scope && currTable->GetScope() != 0)) {
-        currTable = currTable->GetNextTable();
-        if (currTable == nullptr) {
-            throw std::runtime_error("3: No Symbol Table for " + variable);
-        }
+int &Interpreter::storage(const SlotBinding &binding, int index /*default 0*/) {
+    if (index < 0 || index >= binding.size) {
+        throw std::out_of_range("Index " + to_string(index) +
+                                " out of range for variable of size " +
+                                to_string(binding.size));
     }
+    if (binding.frame == 0)
+        return globals[binding.slot + index];
+    return locals[frameBases.back() + binding.slot + index];
+}
 
-    currTable->setDeclared(true);
+// Evaluates the arguments of a call in the caller's frame and pushes a new
+// activation record for the callee holding them. Returns the node following
+// the last argument.
+NodePtr Interpreter::pushFrame(const FunctionEntry &callee, NodePtr arg) {
+    const FrameLayout &layout = resolver.frame(callee.scope);
+    int base = static_cast<int>(locals.size());
+    locals.resize(base + layout.size, 0);
+
+    for (int i = 0; i < callee.paramCount; ++i) {
+        if (!arg) {
+            _globalErrorHandler.handle(37, PC->Value().lineNum(), layout.owner);
+        }
 
-    // if an array set value to an array of the declared size
-    if (currTable->isArray()) {
-        currTable->setValueSize(currTable->GetArraySize());
-    } else {
-        debug<<"Setting Value Size to 1 for "<<currTable->GetName()<<endl;
-        debug<<currTable->GetScope()<<endl;
-        currTable->setValueSize(1);
+        int value;
+        if (arg->Value().type() == Token::Type::Identifier) {
+            NodePtr argNode = arg;
+            int argIndex = 0;
+
+            if (argNode->binding && argNode->binding->isArray) {
+                if (!arg->Right() ||
+                    arg->Right()->Value().type() != Token::Type::LBracket) {
+                    _globalErrorHandler.handle(38, arg->Value().lineNum());
+                }
+
+                // pass [ and move to the index
+                arg = arg->Right()->Right();
+
+                if (arg->Value().type() == Token::Type::Identifier) {
+                    argIndex = variable(arg);
+                } else {
+                    argIndex = stoi(arg->Value().value());
+                }
 
+                // skip ]
+                arg = arg->Right();
+            }
+
+            value = variable(argNode, argIndex);
+        } else {
+            value = stoi(arg->Value().value());
+        }
+
+        locals[base + layout.paramSlots[i]] = value;
+        arg = arg->Right();
     }
+
+    frameBases.push_back(base);
+    return arg;
+}
+
+// Runs the body of a function or procedure whose frame was just pushed and
+// returns to the current PC afterwards
+void Interpreter::callFunction(const FunctionEntry &callee) {
+    // each call recurses on the native stack, stop before it runs out
+    limits.checkCall(stackInUse(), frameBases.size(), PC->Value().lineNum());
+
+    pc_stack.push(PC);
+
+    // begin block node of function
+    PC = callee.entry;
+
+    // change scope
+    scopeStack.push(callee.scope);
+    debug << "adding scope: " << callee.scope << endl;
+
+    executeFunctionOrProcedureCall();
 }
 
 NodePtr Interpreter::iteratePC() {
@@ -84,6 +178,9 @@ NodePtr Interpreter::iteratePC() {
         return nullptr;
     }
 
+    if (limits.due())
+        limits.check(memoryInUse(), PC->Value().lineNum());
+
     // Handling different types of nodes
     switch (PC->getSemanticType()) {
     case Node::Type::BEGIN_BLOCK:
@@ -105,12 +202,7 @@ NodePtr Interpreter::iteratePC() {
         }
         break;
     case Node::Type::DECLARATION:
-        debug << endl << endl << "Within DECLARATION case" << endl << endl;
-        executeDeclaration(PC->Value().value());
-        debug << endl << endl << "Out of the DECLARATION case" << endl << endl;
-        if (!PC)
-            return nullptr;
-
+        // storage is reserved up front by the resolver
         break;
     case Node::Type::ASSIGNMENT:
         // Execute an assignment statements
@@ -169,6 +261,7 @@ NodePtr Interpreter::iteratePC() {
         debug << endl << endl << "Out of the RETURN case" << endl << endl;
 
         scopeStack.pop();
+        returning = true; // unwind any enclosing if/for/while
         if (!PC)
             return nullptr;
 
@@ -217,52 +310,23 @@ NodePtr Interpreter::peekNext(NodePtr node) {
     return node->Right() ? node->Right() : node->Left();
 }
 
-int Interpreter::findNumParamsOfFunctOrProc(const string name) {
-    SymTblPtr currTable = rootTable;
-    int count = 0;
-    while (currTable) {
-
-        if (currTable->GetIdType() == SymbolTable::IDType::parameterList) {
-            if (currTable->procOrFuncName() == name) {
-                count++;
-            }
-        }
-        currTable = currTable->GetNextTable();
-    }
-
-    return count;
-}
-
-SymTblPtr Interpreter::getNthParamOfFuntOrProc(const string name, int num, int scope) {
-    SymTblPtr currTable = rootTable;
-    int count = 0;
-
-    while (currTable) {
-        if (currTable->GetIdType() == SymbolTable::IDType::parameterList) {
-            if (currTable->procOrFuncName() == name) {
-                count++;
-                if (count == num)
-                    return currTable;
-            }
-        }
-        currTable = currTable->GetNextTable();
-    }
-
-    _globalErrorHandler.handle(37, PC->Value().lineNum());
-    return nullptr;
-}
-
 void Interpreter::executeAssignment(NodePtr node) {
     debug << endl << endl << "GOING WITHIN executeAssignment" << endl;
     debug << "Node value of: " << node->Value().value()
          << " and line number : " << node->Value().lineNum() << endl;
 
     bool stringMode = false;
-    auto variableName = node->Value().value();
-
-    SymTblPtr table = getSymbolTable(node->Value().value(), scopeStack.top());
+    const string &variableName = node->Value().value();
+
+    // for loop statements start directly at the assigned identifier
+    NodePtr target = node;
+    if (node->getSemanticType() == Node::Type::ASSIGNMENT)
+        target = node->Right();
+    if (!target->binding) {
+        throw std::runtime_error("No Symbol Table for " + variableName);
+    }
 
-    if (table->isArray() && table->GetDataType() == "char")
+    if (target->binding->isArray && target->binding->dataType == "char")
         stringMode = true;
 
     NodePtr nextNode = node->Right()->Right();
@@ -285,7 +349,7 @@ void Interpreter::executeAssignment(NodePtr node) {
                 }
             }
 
-            updateSymbolTable(variableName, nextNode->Value().value().at(i), scopeStack.top(), i-1);
+            variable(target, i - 1) = nextNode->Value().value().at(i);
         }
 
     } else {
@@ -302,7 +366,7 @@ void Interpreter::executeAssignment(NodePtr node) {
         debug << "Updating symbol table for variableName: " << variableName
              << " and result:  " << result << endl
              << endl;
-        updateSymbolTable(variableName, result, scopeStack.top(), 0);
+        variable(target, 0) = result;
     }
 }
 
@@ -357,10 +421,74 @@ int Interpreter::evaluateExpression(
 
     debug << endl << endl << "GOING WITHIN evaluateExpression" << endl;
 
-    // Current stack being evaluated
-    stack<int> evalStack;
+    // compile on first use, only whole sibling chains are cached on the node
+    CompiledExpression uncached;
+    const CompiledExpression *expr = &uncached;
+    if (endCase) {
+        uncached = compileExpression(exprRoot, endCase, inAssignment);
+    } else {
+        if (!exprRoot->expression ||
+            exprRoot->expression->inAssignment != inAssignment) {
+            expressions.push_back(
+                compileExpression(exprRoot, nullptr, inAssignment));
+            exprRoot->expression = &expressions.back();
+        }
+        expr = exprRoot->expression;
+    }
+
+    // nested calls evaluate their expressions above this base
+    size_t base = operands.size();
+
+    for (const ExpressionOp &op : expr->ops) {
+        switch (op.kind) {
+        case ExpressionOp::Kind::PUSH:
+            operands.push_back(op.value);
+            break;
+        case ExpressionOp::Kind::LOAD:
+            operands.push_back(variable(op.node));
+            break;
+        case ExpressionOp::Kind::LOAD_ELEMENT:
+            operands.back() = variable(op.node, operands.back());
+            break;
+        case ExpressionOp::Kind::CALL:
+            pushFrame(*op.callee, op.node);
+            callFunction(*op.callee);
+            debug << "Finishing the executeFunctionOrProcedureCall: " << endl
+                 << endl;
+            operands.push_back(returnValue);
+            break;
+        case ExpressionOp::Kind::NOT: // only unary case
+            operands.back() = !operands.back();
+            break;
+        case ExpressionOp::Kind::BINARY: {
+            // In postfix order first get right then left
+            int right = operands.back();
+            operands.pop_back();
+            operands.back() = applyOperator(op.op, operands.back(), right,
+                                            expr->inAssignment);
+            break;
+        }
+        case ExpressionOp::Kind::FAIL:
+            _globalErrorHandler.handle(op.value, op.node->Value().lineNum());
+            break;
+        }
+    }
+
+    debug<<"Returning value from top of stack"<<endl;
+    // Whats left on the stack is the result
+    int result = operands.size() > base ? operands.back() : 0;
+    operands.resize(base);
+    return result;
+}
+
+// Translates the postfix sibling chain starting at exprRoot into operations
+// with literals parsed, operators decoded and variables and callees bound
+CompiledExpression
+Interpreter::compileExpression(NodePtr exprRoot, NodePtr endCase,
+                               bool inAssignment) {
+    CompiledExpression expr;
+    expr.inAssignment = inAssignment;
 
-    // Use the root of the expression
     NodePtr currentNode = exprRoot;
 
     // add first identifier to stack separately in case of assignment
@@ -369,250 +497,129 @@ int Interpreter::evaluateExpression(
         if (currentNode->Value().type() != Token::Type::Identifier) {
             _globalErrorHandler.handle(34, currentNode->Value().lineNum());
         }
-        if (currentNode->Right()->Value().type() == Token::Type::LBracket) {
-            string id = currentNode->Value().value();
-
-            // set current node to beginning of inside []
-            currentNode = currentNode->Right()->Right();
+        expr.ops.push_back({ExpressionOp::Kind::PUSH, 0});
 
-            // skip to end bracket
+        if (currentNode->Right() &&
+            currentNode->Right()->Value().type() == Token::Type::LBracket) {
+            // skip to end bracket, the element is written by the assignment
             while (currentNode->Value().type() != Token::Type::RBracket) {
                 currentNode = currentNode->Right();
             }
 
-            // push array access
-            evalStack.push(0);
-
             // start on next part of expression
             currentNode = currentNode->Right();
-        } else {
-            evalStack.push(0);
         }
     }
 
+    compileOperands(currentNode, endCase, expr);
+    return expr;
+}
 
-    while (currentNode != endCase) {
-        debug << "Parsing"
-             << " " << currentNode->Value().value() << endl;
-        if (isOperand(currentNode->Value())) {
-            if (currentNode->Value().type() == Token::Type::Identifier) {
-                // handle array access cases
-                if (currentNode->Right()->Value().type() ==
-                    Token::Type::LBracket) {
-                    string id = currentNode->Value().value();
-
-                    // set current node to beginning of inside []
-                    currentNode = currentNode->Right()->Right();
-
-                    NodePtr temp = currentNode;
-
-                    // skip to end bracket
-                    while (currentNode->Value().type() !=
-                           Token::Type::RBracket) {
-                        currentNode = currentNode->Right();
-                    }
-
-                    int arrayIdx = evaluateExpression(temp, currentNode);
-
-                    // push array access
-
-                    evalStack.push(getSymbolTableValue(id, arrayIdx, scopeStack.top()));
-
-                    // start on next part of expression
-                    currentNode = currentNode->Right();
-                } else {
-                    string id = currentNode->Value().value();
-                    SymTblPtr table = getSymbolTable(id, scopeStack.top());
-
-                    if (table->GetIdType() == SymbolTable::IDType::function) {
-
-                        int numParams = findNumParamsOfFunctOrProc(id);
-
-                        currentNode =
-                            currentNode->Right(); // iterate to next node
-                        // get args for params and set the values for the
-                        // appropriate symbol tables
-                        for (int i = 1; i <= numParams; ++i) {
-
-                            SymTblPtr currParamTbl =
-                                getNthParamOfFuntOrProc(id, i, scopeStack.top());
-
-                            if (!currParamTbl->GetIsDeclared()) {
-                                executeDeclaration(currParamTbl->GetName(), currParamTbl->GetScope());
-                            }
-
-                            // set table value of param before call
-                            if (currentNode->Value().type() ==
-                                Token::Type::Identifier) {
-                                SymTblPtr currArgTable = getSymbolTable(
-                                    currentNode->Value().value(), scopeStack.top());
-                                int argIndex = 0;
-
-                                if (currArgTable->isArray()) {
-                                    if (currentNode->Right()->Value().type() !=
-                                        Token::Type::LBracket) {
-                                        _globalErrorHandler.handle(
-                                            38, currentNode->Value().lineNum());
-                                    }
-
-                                    // save identifier
-                                    string arrayID = currentNode->Value().value();
-
-
-                                    // pass [
-                                    currentNode = currentNode->Right();
-                                    // pass identifier
-                                    currentNode = currentNode->Right();
-
-                                    if (currentNode->Value().type() ==
-                                        Token::Type::Identifier) {
-
-                                        argIndex = getSymbolTableValue(
-                                            currentNode->Value().value(), scopeStack.top());
-
-
-                                    } else {
-
-                                        argIndex =
-                                            stoi(currentNode->Value().value());
-                                    }
-
-                                    // skip argIndex
-                                    currentNode = currentNode->Right();
-
-
-                                    string name = currParamTbl->GetName();
-                                    int value = getSymbolTableValue(arrayID, scopeStack.top(),argIndex);
-                                    int scope = currParamTbl->GetScope();
-
-                                    if (!currParamTbl->GetIsDeclared()){
-                                        executeDeclaration(name, scope);
-                                    }
-
-                                    updateSymbolTable(name, value, scope, 0);
-
-                                } else {
-
-                                    string name = currParamTbl->GetName();
-                                    int value = getSymbolTableValue(currentNode->Value().value(), scopeStack.top(),argIndex);
-                                    int scope = currParamTbl->GetScope();
-
-                                    if (!currParamTbl->GetIsDeclared()){
-                                        executeDeclaration(name, scope);
-                                    }
-
-
-                                    updateSymbolTable(name,value, scope, 0);
-                                }
+void Interpreter::compileOperands(NodePtr node, NodePtr endCase,
+                                  CompiledExpression &expr) {
+    while (node != endCase) {
+        const Token &token = node->value;
 
-                            } else {
-                                updateSymbolTable(
-                                    currParamTbl->GetName(),
-                                    stoi(currentNode->Value().value()), scopeStack.top());
-                            }
+        ExpressionOp op;
+        op.node = node;
 
-                            currentNode =
-                                currentNode->Right(); // iterate to next node
-                        }
+        if (isOperator(token)) {
+            if (token.type() == Token::Type::BooleanNot) {
+                op.kind = ExpressionOp::Kind::NOT;
+            } else {
+                op.kind = ExpressionOp::Kind::BINARY;
+                op.op = token.type();
+            }
+        } else if (token.type() == Token::Type::Identifier) {
+            // handle array access cases
+            if (node->Right() &&
+                node->Right()->Value().type() == Token::Type::LBracket) {
+                NodePtr close = node->Right()->Right();
+                while (close && close->Value().type() != Token::Type::RBracket)
+                    close = close->Right();
+                if (!close) {
+                    _globalErrorHandler.handle(5, token.lineNum());
+                }
 
-                        // push current node on call stack
-                        pc_stack.push(currentNode);
-                        debug << endl << endl << endl << endl;
-                        debug << "Pushing program counter to make function "
-                                "call. Current node is: "
-                             << currentNode->Value().value() << endl;
-                        debug << "Current PC value is: " << PC->Value().value()
-                             << endl;
-                        // find begin block node of function
-                        PC = findFunctOrProcStart(id);
+                // index is evaluated first, then replaced by the element
+                compileOperands(node->Right()->Right(), close, expr);
+                op.kind = ExpressionOp::Kind::LOAD_ELEMENT;
+                expr.ops.push_back(op);
 
-                        // change scope
-                        scopeStack.push(getSymbolTable(id, scopeStack.top(), true)->GetScope());
-                        debug<<"adding scope: "<< getSymbolTable(id, scopeStack.top(), true)->GetScope()<<endl;
-
-                        // exec function
-                        executeFunctionOrProcedureCall();
-                        debug << "Finishing the executeFunctionOrProcedureCall: "
-                             << endl
-                             << endl;
-                        if (!PC) {
-                            debug << "PC is null return " << endl;
-                            return evalStack.top();
-                        }
-                        currentNode = PC;
+                node = close->Right();
+                continue;
+            }
 
-                        debug<<"id: "<<id<<endl;
-                        debug<<"Current Scope: "<<scopeStack.top()<<endl;
-                        debug<<"Getting Symbol table value for "<<id<<endl;
-                        evalStack.push(getSymbolTableValue(id, getSymbolTable(id, 0, true)->GetScope()));
-                        debug<<"got it"<<endl;
-                    }
-                    else {
-                        debug<<"id: "<<id<<endl;
-                        debug<<"Current Scope: "<<scopeStack.top()<<endl;
-                        debug<<"Getting Symbol table value for "<<id<<endl;
-                        evalStack.push(getSymbolTableValue(id, scopeStack.top()));
-                        debug<<"got it"<<endl;
-                    }
+            auto callee = functions.find(token.id());
+            if (!node->binding && callee != functions.end() &&
+                callee->second.isFunction) {
+                op.kind = ExpressionOp::Kind::CALL;
+                op.callee = &callee->second;
+                op.node = node->Right(); // first argument
+                expr.ops.push_back(op);
+
+                node = node->Right();
+                if (!skipArguments(callee->second, node))
+                    return; // pushFrame reports the bad call when it runs
+                continue;
+            }
 
-                }
+            op.kind = ExpressionOp::Kind::LOAD;
+        } else if (token.type() == Token::Type::BooleanTrue) {
+            // push token values, with true/false mapping
+            op.kind = ExpressionOp::Kind::PUSH;
+            op.value = 1;
+        } else if (token.type() == Token::Type::BooleanFalse) {
+            op.kind = ExpressionOp::Kind::PUSH;
+            op.value = 0;
+        } else if (token.type() == Token::Type::SingleQuotedString ||
+                   token.type() == Token::Type::DoubleQuotedString) {
+            // check that is a single char (string of size 1 + quotes)
+            if (token.value().size() != 3) {
+                op.kind = ExpressionOp::Kind::FAIL;
+                op.value = 36;
             } else {
-                // push token values, with true/false mapping
-                if (currentNode->Value().type() == Token::Type::BooleanTrue) {
-                    evalStack.push(1);
-                } else if (currentNode->Value().type() ==
-                           Token::Type::BooleanFalse) {
-                    evalStack.push(0);
-                } else if (currentNode->Value().type() ==
-                               Token::Type::SingleQuotedString ||
-                           currentNode->Value().type() ==
-                               Token::Type::DoubleQuotedString) {
-                    // check that is a single char (string of size 1 + quotes)
-                    if (currentNode->Value().value().size() != 3)
-                        _globalErrorHandler.handle(
-                            36, currentNode->Value().lineNum());
-
-                    int ascii = currentNode->Value().value()[1];
-                    evalStack.push(ascii);
-                } else {
-                    evalStack.push(stoi(currentNode->Value().value()));
-                }
+                op.kind = ExpressionOp::Kind::PUSH;
+                op.value = token.value()[1];
             }
-
         } else {
+            op.kind = ExpressionOp::Kind::PUSH;
+            op.value = stoi(token.value());
+        }
 
-            Token::Type op = currentNode->Value().type();
+        expr.ops.push_back(op);
+        node = node->Right();
+    }
+}
 
-            if (op == Token::Type::BooleanNot) { // only unary case
-                int operand = evalStack.top();
-                evalStack.pop();
-                evalStack.push(!operand);
-            } else {
-                // In postfix order first get right then left
-                int right = evalStack.top();
-                evalStack.pop();
-                int left = evalStack.top();
-                evalStack.pop();
-                int result = applyOperator(op, left, right, inAssignment);
-                evalStack.push(result);
+// Moves arg past the arguments of a call the same way pushFrame consumes
+// them. Returns false if the arguments are malformed.
+bool Interpreter::skipArguments(const FunctionEntry &callee, NodePtr &arg) {
+    for (int i = 0; i < callee.paramCount; ++i) {
+        if (!arg)
+            return false;
+
+        if (arg->Value().type() == Token::Type::Identifier && arg->binding &&
+            arg->binding->isArray) {
+            // skip [ index ]
+            for (int j = 0; j < 3; ++j) {
+                arg = arg->Right();
+                if (!arg)
+                    return false;
             }
         }
-
-        currentNode = currentNode->Right();
+        arg = arg->Right();
     }
-
-    debug<<"Returning value from top of stack"<<endl;
-    // Whats left on the stack is the result
-    return evalStack.top();
+    return true;
 }
 
 // Determine if the node represents an operand
-bool Interpreter::isOperand(Token t) {
+bool Interpreter::isOperand(const Token &t) {
     return !isOperator(t);
     // Just lookin for plus and minus right now for simplicty
 }
 
-bool Interpreter::isOperator(Token t) {
+bool Interpreter::isOperator(const Token &t) {
     if (t.type() == Token::Type::Plus || t.type() == Token::Type::Minus ||
         t.type() == Token::Type::Slash || t.type() == Token::Type::Asterisk ||
         t.type() == Token::Type::Modulo || t.type() == Token::Type::Caret ||
@@ -632,450 +639,367 @@ void Interpreter::executeIF() {
 
     debug << "EXECUTING IF" << endl;
 
-    int bCount = 0;
-
-    bool choseIf = false;
-
-    PC = PC->Right();
+    const ControlFlow &flow = controlFlow.at(PC);
 
     // evaluate expression
-    int result = evaluateExpression(PC);
+    int result = evaluateExpression(flow.condition);
 
     if (result != 0) { // execute if block and skip the else (if it exists)
         debug << "Entering IF block" << endl;
 
-        while (PC->getSemanticType() != Node::Type::BEGIN_BLOCK) {
-            PC = peekNext(PC);
-        }
-
-        choseIf = true;
+        PC = flow.body;
         while (PC->getSemanticType() != Node::Type::END_BLOCK) {
             iteratePC();
-            if (!PC)
+            if (!PC || returning)
                 return;
         }
 
-        if (peekNext(PC)->getSemanticType() == Node::Type::ELSE) {
+        if (flow.elseBody) {
             debug << "Skipping ELSE block" << endl;
-
-            PC = peekNext(PC); // skip end block
-
-            debug << "skip else" << endl;
-            // skip over else block
-            while (bCount > 0 ||
-                   PC->getSemanticType() != Node::Type::END_BLOCK) {
-                PC = peekNext(PC);
-                if (PC->getSemanticType() == Node::Type::BEGIN_BLOCK)
-                    bCount++;
-                if (PC->getSemanticType() == Node::Type::END_BLOCK)
-                    bCount--;
-            }
-
-            // step past end block of else
+            PC = flow.elseEnd;
         }
 
-    } else { // skip if block and execute else block (if it exists)
-        debug << "Skipping IF block, checking for ELSE" << endl;
-
-        // skip over if block
-        while (bCount > 0 || PC->getSemanticType() != Node::Type::END_BLOCK) {
-            PC = peekNext(PC);
-            if (PC->getSemanticType() == Node::Type::BEGIN_BLOCK)
-                bCount++;
-            if (PC->getSemanticType() == Node::Type::END_BLOCK)
-                bCount--;
-        }
+    } else if (flow.elseBody) { // skip if block and execute else block
+        debug << "entering else" << endl;
 
-        // look for else
-        if (peekNext(PC)->getSemanticType() == Node::Type::ELSE) {
-            // step past end block of if
-            PC = peekNext(PC);
-
-            debug << "entering else" << endl;
-            while (PC->getSemanticType() != Node::Type::END_BLOCK) {
-                iteratePC();
-                if (!PC)
-                    return;
-            }
+        PC = flow.elseBody;
+        while (PC->getSemanticType() != Node::Type::END_BLOCK) {
+            iteratePC();
+            if (!PC || returning)
+                return;
         }
+    } else {
+        debug << "Skipping IF block" << endl;
+        PC = flow.bodyEnd;
     }
 
     debug << "exiting if" << endl;
     debug << endl
          << "The current PC value of: " << PC->Value().value()
          << " and line number : " << PC->Value().lineNum() << endl;
-//    if (PC)
-//        PC = peekNext(PC); // Move past the last END_BLOCK
-}
-
-int Interpreter::getSymbolTableValue(const string &name,int scope, int index /*default 0*/) {
-    SymTblPtr currTable = rootTable;
-    debug<<"Getting symbol table "<<name<< " With scope "<<scope<<endl;
-
-    while (currTable->GetName() != name || (currTable->GetScope() != scope && currTable->GetScope() != 0)) {
-
-
-        currTable = currTable->GetNextTable();
-
-        if (currTable == nullptr) {
-            throw std::runtime_error("4: No Symbol Table for " + name);
-        }
-    }
-    debug<<"Current Index "<<index<<endl;
-    debug<<"Returning table "<<currTable->GetName()<<" with value size "<<currTable->GetValue().size()<<endl;
-    return currTable->GetValue().at(index);
-}
-
-void Interpreter::updateSymbolTable(const string &name, int value,int scope,
-                                    int index /*default 0*/ ) {
-    // Needs logic to update the symbol table entry for 'name' with 'value'
-    // Will be used in assignments
-    SymTblPtr tempRoot = rootTable;
-
-    if (UpdateTable(tempRoot, name, value, index, scope)) {
-        return;
-    } else {
-        debug << "failed to update symbol table value with name (" << name
-             << ") to value (" << value << ")" << " with scope: " << scope << endl;
-        exit(377);
-    }
-}
-
-bool Interpreter::UpdateTable(SymTblPtr root, const string &name, int value,
-                              int index, int scope) {
-    if (root == nullptr) {
-        return false;
-    }
-    if (root->GetName() == name && (root->GetScope() == scope || root->GetScope() == 0)) {
-        root->setValue(value, index);
-        return true;
-    }
-
-    return UpdateTable(root->GetNextTable(), name, value, index, scope);
 }
 
 void Interpreter::executeFor() {
 
     debug << "Entering For" << endl;
-    PC = peekNext(PC);
 
-    // grab initial statement
-    NodePtr initStmt = peekNext(PC); // skip to var name
+    const ControlFlow &flow = controlFlow.at(PC);
 
-    // skip to condition
-    while (PC->Right()) {
-        PC = PC->Right();
-    }
+    executeAssignment(flow.init);
 
-    NodePtr condition = PC->Left()->Right();
-    PC = condition;
-
-    // skip to update statement
-    while (PC->Right())
-        PC = PC->Right();
-    NodePtr updateStmt = PC->Left()->Right();
-
-    // skip to body
-    while (peekNext(PC)->getSemanticType() != Node::Type::BEGIN_BLOCK) {
-        PC = peekNext(PC);
-    }
-
-    NodePtr body = peekNext(PC);
-
-    executeAssignment(initStmt);
-
-    while (evaluateExpression(condition)) {
+    while (evaluateExpression(flow.condition)) {
         debug << "While evaluating expression in for loop" << endl
              << endl
              << endl;
 
-        PC = body; // Proceed after the for-loop
+        PC = flow.body;
 
         while (PC->getSemanticType() != Node::Type::END_BLOCK) {
 
             iteratePC();
-            if (!PC)
+            if (!PC || returning)
                 return;
         }
 
-        executeAssignment(updateStmt);
+        executeAssignment(flow.update);
     }
 
-    // Move PC past the for loop
-//    PC = peekNext(PC);
-
-    //debug << "Exiting For" << endl;
+    // continue after the end of the body
+    PC = flow.bodyEnd;
 }
 
 void Interpreter::executeWhile() {
     debug << endl << endl << "ENTERING WHILE LOOP" << endl;
 
-    // grab initial statement
-    NodePtr condition = peekNext(PC); // skip to var name
-    debug << "condition is: " << condition->Value().value() << endl;
-    PC = condition;
-
-    // skip to body (FOR NOW JUST ONE STATEMENT IN WHILE)
-    while (peekNext(PC)->getSemanticType() != Node::Type::BEGIN_BLOCK) {
-        PC = peekNext(PC);
-    }
-
-    NodePtr body = peekNext(PC);
+    const ControlFlow &flow = controlFlow.at(PC);
 
-    while (evaluateExpression(condition)) {
+    while (evaluateExpression(flow.condition)) {
         debug << "During evaluating expression in While loop" << endl
              << endl
              << endl;
-        PC = body; // Proceed after while loop
-        debug << "PC value for body is now: " << PC->Value().value() << endl;
 
-        while (peekNext(PC)->getSemanticType() != Node::Type::END_BLOCK) {
+        PC = flow.body;
+
+        while (PC->getSemanticType() != Node::Type::END_BLOCK) {
             iteratePC();
-            debug << endl << endl << "After IteratePC in While loop" << endl;
-            debug << endl
-                 << "PC value is: " << PC->Value().value()
-                 << " and line number : " << PC->Value().lineNum() << endl;
-
-            if (PC->getSemanticType() == Node::Type::END_BLOCK &&
-                PC->Left() == nullptr) {
-                debug << "! Within iterate PC and if block with PC value of: "
-                     << PC->Value().value()
-                     << " and line number : " << PC->Value().lineNum() << endl;
-                debug << "!! Semantic type is: "
-                     << PC->semanticTypeToString(PC->getSemanticType()) << endl;
-
-                PC = nullptr;
+            if (!PC || returning)
                 return;
-            }
         }
     }
     debug << endl << endl << "After condition is false." << endl;
-    debug << endl
-         << "PC value is: " << PC->Value().value()
-         << " and line number : " << PC->Value().lineNum() << endl;
 
-    // Move PC past the for loop
-    PC = peekNext(PC);
+    // continue after the end of the body
+    PC = flow.bodyEnd;
 
     debug << endl << endl << "EXITING WHILE LOOP" << endl;
 }
 
 void Interpreter::executePrintF(NodePtr Node) {
     debug << "Executing printf ..." << endl;
-    // copy of original node
-    NodePtr currNode = Node;
 
-    // first node should be printf so the next one will contain the string
-    currNode = currNode->Right();
+    auto found = printFormats.find(Node);
+    if (found == printFormats.end())
+        found = printFormats.emplace(Node, parsePrintF(Node)).first;
+    const PrintFormat &format = found->second;
 
-    // obtain the string value from the node
-    string printStatement = currNode->Value().value();
+    for (const PrintSegment &segment : format.segments) {
+        switch (segment.kind) {
+        case PrintSegment::Kind::TEXT:
+            output.write(segment.text);
+            break;
+        case PrintSegment::Kind::INT:
+            output.writeInt(storage(*segment.binding));
+            break;
+        case PrintSegment::Kind::STRING:
+            output.writeCharArray(&storage(*segment.binding),
+                                  segment.binding->size);
+            break;
+        case PrintSegment::Kind::EXIT:
+            exit(segment.code);
+        case PrintSegment::Kind::FAIL:
+            throw std::runtime_error(segment.text);
+        }
+    }
 
-    // move the currnode to either a nullptr or first argument
-    currNode = currNode->Right();
+    debug << "Done executing printf" << endl;
 
-    vector<string> arguments;
-    int arg_Index = 0;
+    PC = format.last;
+}
 
-    // go until the end of the printf statement
+// Splits the format string of a printf row into literal text and the
+// arguments printed between it. Arguments are the identifiers after the
+// format string, in order. Errors become segments so they still happen only
+// when the printf runs, after the text before them is printed.
+PrintFormat Interpreter::parsePrintF(NodePtr row) {
+    PrintFormat format;
+
+    // first node is printf so the next one contains the string
+    NodePtr currNode = row->Right();
+    const string &printStatement = currNode->Value().value();
+
+    vector<NodePtr> arguments;
+    for (currNode = currNode->Right(); currNode; currNode = currNode->Right()) {
+        if (currNode->Value().type() == Token::Type::Identifier)
+            arguments.push_back(currNode);
+    }
 
-    while (currNode != nullptr) {
+    format.last = row;
+    while (format.last->Right())
+        format.last = format.last->Right();
 
-        // if the value is a string argument add the to the corresponding vector
-        if (currNode->Value().type() == Token::Type::Identifier) {
-            arguments.push_back(currNode->Value().value());
+    string text;
+    auto add = [&](PrintSegment segment) {
+        if (!text.empty()) {
+            format.segments.push_back({PrintSegment::Kind::TEXT, move(text)});
+            text.clear();
         }
-        // if the value is a int argument add the to the corresponding vector
+        format.segments.push_back(move(segment));
+    };
 
-        currNode = currNode->Right();
-    }
-
-    // if both vectors are empty then no arguments were used so just print the
-    // string and exit function
+    // without arguments the quotes are dropped and an escape only prints
+    // the newline of a \ at the end of a line
     if (arguments.empty()) {
         for (int i = 1; i < printStatement.size() - 1; ++i) {
-
-            if (printStatement[i] == '\\'){
+            if (printStatement[i] == '\\') {
                 i++;
-                if (printStatement[i] == '\n'){
-                    cout << endl;
-                }
+                if (printStatement[i] == '\n')
+                    text += '\n';
+            } else {
+                text += printStatement[i];
             }
-            else
-                cout << printStatement[i];
         }
-
-
-        while (PC->Right())
-            PC = PC->Right();
-
-        debug << "Done executing printf" << endl;
-
-        return;
+        if (!text.empty())
+            format.segments.push_back({PrintSegment::Kind::TEXT, move(text)});
+        return format;
     }
 
-    // we do have arguments passed so parse the print statement printing
-    // character by character if we come across a % check the next character to
-    // print the right argument if we see a \ then check for an n to add space
-    // character
+    // with arguments %d and %s print the next one and \n prints a space
+    size_t argIndex = 0;
     for (int i = 0; i < printStatement.size(); i++) {
         if (printStatement.at(i) == '%') {
             i++;
-            if (printStatement.at(i) == 'd') {
-
-                cout << getSymbolTableValue(arguments.at(arg_Index), scopeStack.top());
-                arg_Index++;
-            } else if (printStatement.at(i) == 's') {
-                SymTblPtr currTable = rootTable;
-                while (currTable->GetName() != arguments.at(arg_Index)) {
-                    currTable = currTable->GetNextTable();
-                    if (currTable == nullptr) {
-                        throw std::runtime_error("5: o Symbol Table for " +
-                                                 arguments.at(arg_Index));
-                    }
-                }
-
-                vector<int> astring = currTable->GetValue();
-                for (int i = 0; i < astring.size(); i++) {
-                    if (astring.at(i) == '\\') {
-                        i++;
-                        if (astring.at(i) == 'x') {
-                            i++;
-                            if (astring.at(i) == '0') {
-                                break;
-                            }
-                        }
-                    }
-                    if (astring.at(i) != 0)
-                        cout << static_cast<char>(astring.at(i));
-                }
-                arg_Index++;
-
-            } else {
-                exit(411);
+            char spec = printStatement.at(i);
+            if (spec != 'd' && spec != 's') {
+                add({PrintSegment::Kind::EXIT, "", nullptr, 411});
+                return format;
+            }
+            if (argIndex >= arguments.size()) {
+                add({PrintSegment::Kind::FAIL,
+                     "Missing argument for printf on line " +
+                         to_string(row->Value().lineNum())});
+                return format;
             }
 
+            NodePtr argument = arguments[argIndex++];
+            if (!argument->binding) {
+                add({PrintSegment::Kind::FAIL,
+                     (spec == 'd' ? "No Symbol Table for "
+                                  : "5: o Symbol Table for ") +
+                         argument->Value().value()});
+                return format;
+            }
+            add({spec == 'd' ? PrintSegment::Kind::INT
+                             : PrintSegment::Kind::STRING,
+                 "", argument->binding});
         } else if (printStatement.at(i) == '\\') {
             i++;
-            if (printStatement.at(i) == 'n') {
-                cout << " ";
-            } else {
-                exit(412);
+            if (printStatement.at(i) != 'n') {
+                add({PrintSegment::Kind::EXIT, "", nullptr, 412});
+                return format;
             }
-
-        } else {
-            if (printStatement[i] != '"')
-                cout << printStatement[i];
+            text += ' ';
+        } else if (printStatement[i] != '"') {
+            text += printStatement[i];
         }
     }
-    debug << endl;
-
-    debug << "Done executing printf" << endl;
-
-    while (PC->Right())
-        PC = PC->Right();
-
-    return;
+    if (!text.empty())
+        format.segments.push_back({PrintSegment::Kind::TEXT, move(text)});
+    return format;
 }
 
-NodePtr Interpreter::findFunctOrProcStart(const string name) {
-    debug << "Searching for function/procedure: " << name << endl;
-
+// Walks the AST once, pairing each declaration with its symbol table, and
+// records where every function and procedure body begins
+void Interpreter::buildFunctionDirectory() {
     NodePtr currNode = astRoot;
     SymTblPtr currTable = rootTable;
 
-    while (currNode) {
+    while (currNode && currTable) {
         if (currNode->getSemanticType() == Node::Type::DECLARATION) {
             // Get next symbol table for each declaration found in AST
             debug << "FOUND DECLARATION WITH NAME: " << currTable->GetName()
                  << endl;
 
-            if (currTable->GetName() == name) {
-
-                while (currNode->getSemanticType() != Node::Type::BEGIN_BLOCK) {
-                    currNode = peekNext(currNode);
+            if (currTable->GetIdType() == SymbolTable::IDType::function ||
+                currTable->GetIdType() == SymbolTable::IDType::procedure) {
+                NodePtr entry = currNode;
+                while (entry &&
+                       entry->getSemanticType() != Node::Type::BEGIN_BLOCK) {
+                    entry = peekNext(entry);
                 }
 
-                return currNode;
+                int scope = currTable->GetScope();
+                const FrameLayout &layout = resolver.frame(scope);
+                functions[currTable->GetNameId()] = {
+                    entry, static_cast<int>(layout.paramSlots.size()), scope,
+                    layout.isFunction};
             }
 
             currTable = currTable->GetNextTable();
 
             // iterate past tables formed by params
-            while (currTable->GetIdType() == SymbolTable::IDType::parameterList)
+            while (currTable &&
+                   currTable->GetIdType() == SymbolTable::IDType::parameterList)
                 currTable = currTable->GetNextTable();
         }
         currNode = peekNext(currNode);
     }
-    throw std::runtime_error("Function or Procedure not found.");
 }
 
-SymTblPtr Interpreter::getSymbolTable(const std::string &name, int scope, bool isProOrFun) {
-    SymTblPtr currTable = rootTable;
-
-    if (isProOrFun){
-        while (currTable->GetName() != name ||
-               (currTable->GetIdType() != SymbolTable::IDType::procedure && currTable->GetIdType() != SymbolTable::IDType::function))
-        {
-
-            currTable = currTable->GetNextTable();
-            if (currTable == nullptr) {
-                throw std::runtime_error("1: No Symbol Table for " + name);
-            }
-        }
-
-        return currTable;
+const FunctionEntry &Interpreter::findFunction(int nameId) {
+    auto function = functions.find(nameId);
+    if (function == functions.end() || !function->second.entry) {
+        throw std::runtime_error("Function or Procedure not found.");
     }
+    return function->second;
+}
 
-    while (currTable->GetName() != name ) {
-
-        currTable = currTable->GetNextTable();
+// Every statement in the AST is a row of right siblings, the next statement
+// hangs off the left child of the last node in the row
+static NodePtr nextRow(NodePtr row) {
+    while (row->Right())
+        row = row->Right();
+    return row->Left();
+}
 
-        if (currTable == nullptr) {
-            throw std::runtime_error("2:No Symbol Table for " + name);
-        }
+// END_BLOCK closing the block that starts at 'begin'
+static NodePtr matchingEnd(NodePtr begin) {
+    int bCount = 0;
+    for (NodePtr row = begin; row; row = nextRow(row)) {
+        if (row->getSemanticType() == Node::Type::BEGIN_BLOCK)
+            bCount++;
+        if (row->getSemanticType() == Node::Type::END_BLOCK && --bCount == 0)
+            return row;
     }
-
-    return currTable;
+    _globalErrorHandler.handle(6, begin->Value().lineNum());
+    return nullptr;
 }
 
-SymTblPtr Interpreter::getSTofFuncOrProcByScope(const int scope) {
-    SymTblPtr currTable = rootTable;
-    while (currTable) {
-
-        if (currTable->GetIdType() == SymbolTable::IDType::function ||
-            currTable->GetIdType() == SymbolTable::IDType::procedure) {
+// First BEGIN_BLOCK at or after 'row'
+static NodePtr nextBlock(NodePtr row) {
+    NodePtr start = row;
+    while (row && row->getSemanticType() != Node::Type::BEGIN_BLOCK)
+        row = nextRow(row);
+    if (!row) {
+        _globalErrorHandler.handle(6, start->Value().lineNum());
+    }
+    return row;
+}
 
-            if (currTable->GetScope() == scope)
-                return currTable;
+// Records the condition, body, else and end targets of every IF, WHILE and
+// FOR row so taking a branch or entering a loop never has to scan
+void Interpreter::buildControlFlow() {
+    for (NodePtr row = astRoot; row; row = nextRow(row)) {
+        ControlFlow flow;
+
+        switch (row->getSemanticType()) {
+        case Node::Type::IF: {
+            flow.condition = row->Right();
+            flow.body = nextBlock(nextRow(row));
+            flow.bodyEnd = matchingEnd(flow.body);
+
+            NodePtr next = nextRow(flow.bodyEnd);
+            if (next && next->getSemanticType() == Node::Type::ELSE) {
+                flow.elseBody = nextBlock(nextRow(next));
+                flow.elseEnd = matchingEnd(flow.elseBody);
+            }
+            break;
         }
-
-        currTable = currTable->GetNextTable();
-        if (currTable == nullptr) {
-            throw std::runtime_error("No funct or proc for scope " + scope);
+        case Node::Type::WHILE:
+            flow.condition = row->Right();
+            flow.body = nextBlock(nextRow(row));
+            flow.bodyEnd = matchingEnd(flow.body);
+            break;
+        case Node::Type::FOR: {
+            NodePtr initRow = nextRow(row);            // For_Expression_1
+            NodePtr conditionRow = nextRow(initRow);   // For_Expression_2
+            NodePtr updateRow = nextRow(conditionRow); // For_Expression_3
+
+            flow.init = initRow->Right();
+            flow.condition = conditionRow->Right();
+            flow.update = updateRow->Right();
+            flow.body = nextBlock(nextRow(updateRow));
+            flow.bodyEnd = matchingEnd(flow.body);
+            break;
+        }
+        default:
+            continue;
         }
-    }
 
-    return currTable;
+        controlFlow[row] = flow;
+    }
 }
 
 void Interpreter::executeFunctionOrProcedureCall() {
     debug << "Entering function/procedure call..." << endl;
 
-    // Save curr scope for comparison
-    int initialScope = scopeStack.top();
+    // Save call depth for comparison, recursive calls share the same scope
+    size_t depth = scopeStack.size();
 
-    // While in same scope (function has not returned)
-    while (scopeStack.top() == initialScope) {
+    // While the function has not returned
+    while (scopeStack.size() >= depth && !returning) {
         debug << "Current PC before iterating: " << PC->Value().value()
              << ", Line: " << PC->Value().lineNum() << endl;
         iteratePC();
         if (!PC)
             break;
     }
+    returning = false;
 
-    // After returning from function
+    // After returning from function, drop its activation record
     debug << "Exiting function/procedure call..." << endl;
+    locals.resize(frameBases.back());
+    frameBases.pop_back();
+
     // Ensure PC is restored
     if (!pc_stack.empty()) {
         PC = pc_stack.top();
@@ -1087,120 +1011,25 @@ void Interpreter::executeFunctionOrProcedureCall() {
 
 void Interpreter::executeReturn() {
     debug << "Executing return" << endl;
-    int retValue;
-
-    if (PC->Right()->Value().type() == Token::Type::Identifier) {
-
-        retValue = getSymbolTableValue(PC->Right()->Value().value(), scopeStack.top());
-    } else {
-        retValue = stoi(PC->Right()->Value().value());
-    }
-
-    string tblID = getSTofFuncOrProcByScope(scopeStack.top())->GetName();
 
-    // store return value in value of func/proc
-    executeDeclaration(tblID);
-    updateSymbolTable(tblID, retValue, scopeStack.top());
+    // store return value until the caller picks it up
+    if (PC->Right())
+        returnValue = evaluateExpression(PC->Right());
+    else
+        returnValue = 0;
 }
 
 void Interpreter::executeCall() {
 
-    string pfName = PC->Value().value();
-
-    debug << "entering call with PC: " << pfName << endl;
-
-
+    debug << "entering call with PC: " << PC->Value().value() << endl;
 
-    int numParams = findNumParamsOfFunctOrProc(pfName);
-
-    PC = peekNext(PC);
-
-    for (int i = 1; i <= numParams; ++i) {
-        SymTblPtr currParamTbl = getNthParamOfFuntOrProc(pfName, i, scopeStack.top());
-
-        if (!currParamTbl->GetIsDeclared()) {
-            executeDeclaration(currParamTbl->GetName(), currParamTbl->GetScope());
-        }
-
-        // set table value of param before call
-        if (PC->Value().type() == Token::Type::Identifier) {
-            SymTblPtr currArgTable = getSymbolTable(
-                PC->Value().value(), scopeStack.top());
-            int argIndex = 0;
-
-            if (currArgTable->isArray()) {
-                if (PC->Right()->Value().type() !=
-                    Token::Type::LBracket) {
-                    _globalErrorHandler.handle(
-                        38, PC->Value().lineNum());
-                }
-
-                // save identifier
-                string arrayID = PC->Value().value();
-
-
-                // pass [
-                PC = PC->Right();
-                // pass identifier
-                PC = PC->Right();
-
-                if (PC->Value().type() ==
-                    Token::Type::Identifier) {
-
-                    argIndex = getSymbolTableValue(
-                        PC->Value().value(), scopeStack.top());
-
-
-                } else {
-
-                    argIndex =
-                        stoi(PC->Value().value());
-                }
-
-                // skip argIndex
-                PC = PC->Right();
-
-
-                string name = currParamTbl->GetName();
-                int value = getSymbolTableValue(arrayID, scopeStack.top(),argIndex);
-                int scope = currParamTbl->GetScope();
-
-                if (!currParamTbl->GetIsDeclared()){
-                    executeDeclaration(name, scope);
-                }
-
-                updateSymbolTable(name, value, scope, 0);
-
-            } else {
-
-                string name = currParamTbl->GetName();
-                int value = getSymbolTableValue(PC->Value().value(), scopeStack.top(),argIndex);
-                int scope = currParamTbl->GetScope();
-
-                if (!currParamTbl->GetIsDeclared()){
-                    executeDeclaration(name, scope);
-                }
-
-
-                updateSymbolTable(name,value, scope, 0);
-            }
-
-        } else {
-            updateSymbolTable(
-                currParamTbl->GetName(),
-                stoi(PC->Value().value()), scopeStack.top());
-        }
-
-
-    }
-
-    pc_stack.push(PC);
-
-    PC = findFunctOrProcStart(pfName);
-    scopeStack.push(getSymbolTable(pfName, scopeStack.top(), true)->GetScope());
-
-    executeFunctionOrProcedureCall();
+    const FunctionEntry &callee = findFunction(PC->Value().id());
 
+    pushFrame(callee, PC->Right());
 
+    // resume after the last argument once the call returns
+    while (PC->Right())
+        PC = PC->Right();
 
-}
\ No newline at end of file
+    callFunction(callee);
+}
@@ -5,57 +5,108 @@
 #define INTERPRETER_H
 
 #include "../AST/ASTParser.h"
+#include "../Limits/ExecutionLimits.h"
 #include "../Node/Node.h"
+#include "../Output/OutputSink.h"
+#include "../SymbolTable/SymbolResolver.h"
 #include "../SymbolTable/SymbolTablesLinkedList.h"
+#include "CompiledExpression.h"
+#include "PrintFormat.h"
+#include <deque>
 #include <stack>
+#include <unordered_map>
 
 using namespace std;
 
+// Where a function or procedure body starts and how to call it
+struct FunctionEntry {
+    NodePtr entry = nullptr; // BEGIN_BLOCK of the body
+    int paramCount;
+    int scope;
+    bool isFunction;
+};
+
+// Targets of an IF, WHILE or FOR row, found once before execution
+struct ControlFlow {
+    NodePtr condition = nullptr;
+    NodePtr body = nullptr;     // BEGIN_BLOCK run while the condition holds
+    NodePtr bodyEnd = nullptr;  // END_BLOCK closing the body
+    NodePtr elseBody = nullptr; // BEGIN_BLOCK of the else branch, if any
+    NodePtr elseEnd = nullptr;
+    NodePtr init = nullptr; // for loops only
+    NodePtr update = nullptr;
+};
+
 class Interpreter {
   public:
-    Interpreter(const NodePtr &astRoot, const SymTblPtr &symTblRoot);
+    Interpreter(const NodePtr &astRoot, const SymTblPtr &symTblRoot,
+                const SymbolResolver &resolver,
+                OutputSink &output = _globalOutput,
+                const ExecutionLimits &limits = _globalLimits);
 
     NodePtr iteratePC();
     NodePtr peekNext(NodePtr node);
 
     int evaluateExpression(NodePtr exprRoot, NodePtr endCase = nullptr, bool inAssignment = false);
+    CompiledExpression compileExpression(NodePtr exprRoot, NodePtr endCase, bool inAssignment);
+    void compileOperands(NodePtr node, NodePtr endCase, CompiledExpression &expr);
+    bool skipArguments(const FunctionEntry &callee, NodePtr &arg);
+
+    int &variable(const NodePtr &node, int index = 0);
+    int &storage(const SlotBinding &binding, int index = 0);
 
-    void updateSymbolTable(const string &name, int value, int scope, int index = 0 );
-    int getSymbolTableValue(const string &name, int scope, int index = 0);
-    SymTblPtr getSymbolTable(const string &name, int scope, bool isProOrFun = false);
-    SymTblPtr getSTofFuncOrProcByScope(const int scope);
-    SymTblPtr getNthParamOfFuntOrProc (const string name, int num, int scope);
+    NodePtr pushFrame(const FunctionEntry &callee, NodePtr arg);
+    void callFunction(const FunctionEntry &callee);
 
-    NodePtr findFunctOrProcStart (const string name);
-    int findNumParamsOfFunctOrProc(const string name);
+    void buildFunctionDirectory();
+    void buildControlFlow();
+    const FunctionEntry &findFunction(int nameId);
 
 
-    bool isOperand(Token t);
-    bool isOperator(Token t);
+    bool isOperand(const Token &t);
+    bool isOperator(const Token &t);
     int applyOperator(Token::Type op, int left, int right, bool inAssignment = false);
-    bool UpdateTable(SymTblPtr root,const string &name,int value, int index, int scope);
     void executeFunctionOrProcedureCall();
 
-    void executeDeclaration(string variable, int scope = -1);
     void executeAssignment(NodePtr node);
     void executeIF();
     void executeFor();
     void executeWhile();
     void executeCall();
     void executePrintF(NodePtr node);
+    PrintFormat parsePrintF(NodePtr row);
     void executeReturn ();
 
   private:
     SymTblPtr rootTable;
-    NodePtr astRoot;
+    NodePtr astRoot = nullptr;
+    const SymbolResolver &resolver;
+    OutputSink &output; // where printf writes
+    LimitGuard limits;  // checked before every statement
+    size_t memoryInUse() const;
+    size_t stackInUse() const;
+    uintptr_t stackBase; // native stack when execution began, calls recurse
+
+    unordered_map<int, FunctionEntry> functions; // by interned name
+    unordered_map<const Node *, ControlFlow> controlFlow;
+    unordered_map<const Node *, PrintFormat> printFormats; // by printf row
+
+    vector<int> globals;
+    vector<int> locals;     // activation records of all active calls
+    vector<int> frameBases; // start of each activation record in 'locals'
+
+    vector<int> operands; // evaluation stack shared by nested expressions
+    deque<CompiledExpression> expressions; // cached on nodes, never move
+
+    int returnValue = 0;
+    bool returning = false; // set by return until the call is unwound
 
     stack<int> scopeStack;
 
 
 
-    NodePtr PC;
+    NodePtr PC = nullptr;
 
-    string printF_buffer;
 
     stack<NodePtr> pc_stack;
     stack<NodePtr> arithmetic_stack;
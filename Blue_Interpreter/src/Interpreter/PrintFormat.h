@@ -0,0 +1,31 @@
+#ifndef PRINTFORMAT_H
+#define PRINTFORMAT_H
+
+#include "../Node/Node.h"
+#include <string>
+#include <vector>
+
+// One piece of a printf, in the order it prints
+struct PrintSegment {
+    enum class Kind {
+        TEXT,   // print 'text'
+        INT,    // print the variable bound to 'binding'
+        STRING, // print the char array bound to 'binding' up to "\x0"
+        EXIT,   // end the program with 'code', for an unknown % or \ sequence
+        FAIL,   // throw runtime_error with 'text'
+    };
+
+    Kind kind;
+    std::string text;
+    const SlotBinding *binding = nullptr;
+    int code = 0;
+};
+
+// A printf row with its format string parsed and its arguments resolved,
+// built the first time the row runs
+struct PrintFormat {
+    std::vector<PrintSegment> segments;
+    NodePtr last = nullptr; // last node of the row, where execution continues
+};
+
+#endif // PRINTFORMAT_H
@@ -0,0 +1,63 @@
+#include "ExecutionLimits.h"
+#include "../ErrorHandler/ErrorHandler.h"
+
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+ExecutionLimits _globalLimits;
+
+// Native stack of the thread running the program, the usual 8 MiB where
+// the system doesn't say
+static size_t nativeStackSize() {
+    size_t size = 8 * 1024 * 1024;
+#if defined(__unix__) || defined(__APPLE__)
+    rlimit stack;
+    if (getrlimit(RLIMIT_STACK, &stack) == 0 && stack.rlim_cur != RLIM_INFINITY)
+        size = stack.rlim_cur;
+#endif
+    return size;
+}
+
+LimitGuard::LimitGuard(const ExecutionLimits &limits)
+    : limits(limits), maxStack(nativeStackSize() / 4 * 3),
+      started(chrono::steady_clock::now()) {
+    restart();
+}
+
+void LimitGuard::restart() {
+    interval = CheckInterval;
+    if (limits.maxSteps > 0 && limits.maxSteps - steps < interval)
+        interval = limits.maxSteps - steps + 1; // due on the step past it
+    countdown = interval;
+}
+
+void LimitGuard::check(size_t memory, int line) {
+    steps += interval;
+
+    if (limits.maxSteps > 0 && steps > limits.maxSteps)
+        _globalErrorHandler.handle(40, line, "steps",
+                                   to_string(limits.maxSteps));
+
+    if (limits.maxMemory > 0 && memory > limits.maxMemory)
+        _globalErrorHandler.handle(40, line, "memory",
+                                   to_string(limits.maxMemory) + " bytes");
+
+    if (limits.maxMilliseconds > 0) {
+        auto elapsed = chrono::duration_cast<chrono::milliseconds>(
+            chrono::steady_clock::now() - started);
+        if (elapsed.count() > limits.maxMilliseconds)
+            _globalErrorHandler.handle(
+                40, line, "time", to_string(limits.maxMilliseconds) + " ms");
+    }
+
+    restart();
+}
+
+void LimitGuard::callTooDeep(size_t depth, int line) {
+    _globalErrorHandler.handle(40, line, "call depth", to_string(depth));
+}
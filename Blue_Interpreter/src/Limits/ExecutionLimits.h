@@ -0,0 +1,69 @@
+#ifndef EXECUTIONLIMITS_H
+#define EXECUTIONLIMITS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// How long a program may run before it is stopped with error 40. A limit of
+// 0 is no limit. Memory counts the values a program stores, its variables,
+// frames and operand stack, and for the tree-walker the native stack its
+// calls recurse on, not the interpreter's own data.
+struct ExecutionLimits {
+    uint64_t maxSteps = 0; // statements run, or instructions for the VM
+    size_t maxMemory = 0;  // bytes
+    unsigned maxMilliseconds = 0;
+};
+
+// Limits of every program run by this process, set from the command line
+extern ExecutionLimits _globalLimits;
+
+// Enforces ExecutionLimits from inside an execution loop. due() is all a
+// step costs, the limits are only checked every CheckInterval steps or when
+// the step limit could be reached sooner:
+//
+//     if (guard.due())
+//         guard.check(memoryInUse, line);
+class LimitGuard {
+  public:
+    explicit LimitGuard(const ExecutionLimits &limits);
+
+    bool due() { return --countdown == 0; }
+
+    // Ends the program through the error handler if a limit is exceeded
+    void check(size_t memory, int line);
+
+    // Calls nested deeper than this end the program with error 40 in every
+    // engine, whatever the limits
+    static constexpr size_t MaxCallDepth = 10000;
+
+    // Checked on every call of the VMs, 'depth' counting the new frame
+    void checkCall(size_t depth, int line) {
+        if (depth > MaxCallDepth)
+            callTooDeep(depth, line);
+    }
+
+    // Checked on every call of the tree-walker, which recurses on the
+    // native stack. It also stops once calls use more than three quarters
+    // of that stack, for stacks too small for MaxCallDepth, rather than
+    // letting it overflow.
+    void checkCall(size_t stackInUse, size_t depth, int line) {
+        if (depth > MaxCallDepth || stackInUse > maxStack)
+            callTooDeep(depth, line);
+    }
+
+  private:
+    static constexpr uint64_t CheckInterval = 4096;
+
+    void restart();
+    void callTooDeep(size_t depth, int line);
+
+    const ExecutionLimits &limits;
+    size_t maxStack; // bytes of native stack calls may use
+    uint64_t countdown = 0;
+    uint64_t steps = 0; // counted before the current countdown started
+    uint64_t interval = 0;
+    std::chrono::steady_clock::time_point started;
+};
+
+#endif // EXECUTIONLIMITS_H
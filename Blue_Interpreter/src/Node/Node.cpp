@@ -14,7 +14,7 @@ void Node::addRightSibling(const NodePtr &nodePtr) { rightSibling = nodePtr; }
 NodePtr Node::Left() { return leftChild; }
 NodePtr Node::Right() { return rightSibling; }
 
-Token Node::Value() { return value; }
+const Token &Node::Value() const { return value; }
 
 void Node::setSemanticType(Type newType) { nodeType = newType; }
 Node::Type Node::getSemanticType() const { return nodeType; }
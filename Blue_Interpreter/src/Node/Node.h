@@ -2,15 +2,15 @@
 #define NODE_H
 
 #include "../Token/Token.h"
-#include <memory> // Used for shared_ptr
 #include <string>
 
 // Forward declaration to resolve circular references
 class Node;
+struct SlotBinding;
+struct CompiledExpression;
 
-// Alias for shared_ptr to Node for convenience
-using NodePtr = std::shared_ptr<Node>; // shared_ptr used to help with automatic
-                                       // memory cleanup
+// Nodes are owned by a NodeArena, links between them are plain pointers
+using NodePtr = Node *;
 
 class Node {
   public:
@@ -39,7 +39,7 @@ class Node {
 
     NodePtr Left();
     NodePtr Right();
-    Token Value();
+    const Token &Value() const;
 
     // Constructor
     Node(const Token &val,
@@ -53,8 +53,15 @@ class Node {
 
     Type nodeType; // Store the semantic type of the node
     Token value;   // Value of the node (could be a token or a non-terminal)
-    NodePtr leftChild;
-    NodePtr rightSibling;
+    NodePtr leftChild = nullptr;
+    NodePtr rightSibling = nullptr;
+
+    // Storage of the variable an identifier refers to, set by SymbolResolver
+    const SlotBinding *binding = nullptr;
+
+    // Expression starting at this node, compiled by the Interpreter on first
+    // use and owned by it
+    const CompiledExpression *expression = nullptr;
 };
 
-#endif // NODE_H
\ No newline at end of file
+#endif // NODE_H
\ No newline at end of file
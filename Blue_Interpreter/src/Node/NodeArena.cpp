@@ -0,0 +1,14 @@
+#include "NodeArena.h"
+
+NodePtr NodeArena::create(const Token &val, Node::Type type) {
+    // start a new chunk instead of growing a full one, growing would move
+    // the nodes already handed out
+    if (chunks.empty() || chunks.back().size() == chunks.back().capacity()) {
+        chunks.emplace_back();
+        chunks.back().reserve(ChunkSize);
+    }
+
+    chunks.back().emplace_back(val, type);
+    count++;
+    return &chunks.back().back();
+}
@@ -0,0 +1,27 @@
+#ifndef NODEARENA_H
+#define NODEARENA_H
+
+#include "Node.h"
+#include <vector>
+
+// Owns every CST and AST node of a compilation unit. Nodes are built in
+// place inside fixed size chunks, so their addresses never change and all of
+// them are freed together when the arena goes away.
+class NodeArena {
+  public:
+    NodeArena() = default;
+    NodeArena(const NodeArena &) = delete;
+    NodeArena &operator=(const NodeArena &) = delete;
+
+    NodePtr create(const Token &val, Node::Type type = Node::Type::OTHER);
+
+    size_t size() const { return count; }
+
+  private:
+    static constexpr size_t ChunkSize = 1024;
+
+    std::vector<std::vector<Node>> chunks;
+    size_t count = 0;
+};
+
+#endif // NODEARENA_H
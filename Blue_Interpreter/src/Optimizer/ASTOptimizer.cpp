@@ -0,0 +1,413 @@
+#include "ASTOptimizer.h"
+#include "DeadCodeEliminator.h"
+#include "Rows.h"
+
+#include <climits>
+#include <cmath>
+
+using namespace std;
+
+int _globalOptLevel = 0;
+
+namespace {
+
+bool isBinaryOperator(Token::Type type) {
+    switch (type) {
+    case Token::Type::Plus:
+    case Token::Type::Minus:
+    case Token::Type::Asterisk:
+    case Token::Type::Slash:
+    case Token::Type::Modulo:
+    case Token::Type::Caret:
+    case Token::Type::BooleanAnd:
+    case Token::Type::BooleanOr:
+    case Token::Type::BooleanEqual:
+    case Token::Type::BooleanNotEqual:
+    case Token::Type::Lt:
+    case Token::Type::Gt:
+    case Token::Type::LtEqual:
+    case Token::Type::GtEqual:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Applies a binary operator the way the interpreter and the VMs do. False
+// if the result isn't certain ahead of time: a division by zero, or an
+// overflow, which is left to happen at run time.
+bool evaluate(Token::Type op, int left, int right, int &result) {
+    long long l = left, r = right, value;
+
+    switch (op) {
+    case Token::Type::Plus:
+        value = l + r;
+        break;
+    case Token::Type::Minus:
+        value = l - r;
+        break;
+    case Token::Type::Asterisk:
+        value = l * r;
+        break;
+    case Token::Type::Slash:
+    case Token::Type::Modulo:
+        if (r == 0 || (l == INT_MIN && r == -1))
+            return false;
+        value = op == Token::Type::Slash ? l / r : l % r;
+        break;
+    case Token::Type::Caret: {
+        double power = pow(left, right);
+        if (!(power >= INT_MIN && power <= INT_MAX))
+            return false;
+        value = static_cast<int>(power);
+        break;
+    }
+    case Token::Type::BooleanAnd:
+        value = l && r;
+        break;
+    case Token::Type::BooleanOr:
+        value = l || r;
+        break;
+    case Token::Type::BooleanEqual:
+        value = l == r;
+        break;
+    case Token::Type::BooleanNotEqual:
+        value = l != r;
+        break;
+    case Token::Type::Lt:
+        value = l < r;
+        break;
+    case Token::Type::Gt:
+        value = l > r;
+        break;
+    case Token::Type::LtEqual:
+        value = l <= r;
+        break;
+    case Token::Type::GtEqual:
+        value = l >= r;
+        break;
+    default:
+        return false;
+    }
+
+    if (value < INT_MIN || value > INT_MAX)
+        return false;
+    result = static_cast<int>(value);
+    return true;
+}
+
+// The value of a row that is a single literal
+bool constantCondition(NodePtr row, int &value) {
+    NodePtr node = row->Right();
+    if (!node || node->Right())
+        return false;
+
+    switch (node->value.type()) {
+    case Token::Type::Integer:
+        value = stoi(node->value.value());
+        return true;
+    case Token::Type::BooleanTrue:
+        value = 1;
+        return true;
+    case Token::Type::BooleanFalse:
+        value = 0;
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+ASTOptimizer::ASTOptimizer(NodeArena &arena, SymTblPtr &symTableRoot,
+                           int level)
+    : arena(arena), symTableRoot(symTableRoot), level(level) {
+    for (SymTblPtr table = symTableRoot; table; table = table->GetNextTable())
+        if (table->GetIdType() == SymbolTable::IDType::function ||
+            table->GetIdType() == SymbolTable::IDType::procedure)
+            functionNames.insert(table->GetNameId());
+}
+
+void ASTOptimizer::optimize(NodePtr &astRoot) {
+    if (level <= 0)
+        return;
+
+    NodePtr previous = nullptr;
+    NodePtr row = astRoot;
+    while (row) {
+        switch (row->getSemanticType()) {
+        case Node::Type::ASSIGNMENT:
+        case Node::Type::IF:
+        case Node::Type::WHILE:
+        case Node::Type::ForExpression1:
+        case Node::Type::ForExpression2:
+        case Node::Type::ForExpression3:
+        case Node::Type::RETURN:
+            foldRow(row);
+            break;
+        default:
+            break;
+        }
+
+        // the rows spliced in place of a removed statement come next
+        if (level >= 2 && previous && removeConstantBranch(previous, row)) {
+            row = nextRow(previous);
+            continue;
+        }
+        previous = row;
+        row = nextRow(row);
+    }
+
+    if (level >= 2)
+        DeadCodeEliminator(astRoot, symTableRoot).eliminate(changes);
+}
+
+// Rewrites the expression of 'row' in place. False if nothing changed.
+bool ASTOptimizer::foldRow(NodePtr row) {
+    vector<NodePtr> nodes;
+    for (NodePtr node = row->Right(); node; node = node->Right()) {
+        if (node->value.type() == Token::Type::Identifier &&
+            functionNames.count(node->value.id()))
+            return false;
+        nodes.push_back(node);
+    }
+    if (nodes.empty())
+        return false;
+
+    size_t noted = changes.size();
+    vector<NodePtr> out;
+    if (!foldRange(nodes, 0, nodes.size(), out) || changes.size() == noted) {
+        changes.resize(noted); // a row we can't read is left as it is
+        return false;
+    }
+
+    NodePtr next = nodes.back()->Left();
+    nodes.back()->leftChild = nullptr;
+    row->rightSibling = out.front();
+    for (size_t i = 0; i + 1 < out.size(); ++i) {
+        out[i]->rightSibling = out[i + 1];
+        out[i]->leftChild = nullptr;
+    }
+    out.back()->rightSibling = nullptr;
+    out.back()->leftChild = next;
+    return true;
+}
+
+// Appends the rewritten postfix expression nodes[begin, end) to 'out'.
+// False if it is malformed.
+bool ASTOptimizer::foldRange(const vector<NodePtr> &nodes, size_t begin,
+                             size_t end, vector<NodePtr> &out) {
+    vector<Term> stack;
+
+    for (size_t i = begin; i < end; ++i) {
+        NodePtr node = nodes[i];
+        Token::Type type = node->value.type();
+        Term term{out.size(), out.size() + 1};
+
+        if (type == Token::Type::Integer) {
+            term.constant = true;
+            term.value = stoi(node->value.value());
+        } else if (type == Token::Type::BooleanTrue ||
+                   type == Token::Type::BooleanFalse) {
+            term.constant = true;
+            term.value = type == Token::Type::BooleanTrue;
+        } else if (type == Token::Type::Identifier && i + 1 < end &&
+                   nodes[i + 1]->value.type() == Token::Type::LBracket) {
+            // a [ index ], the index is an expression of its own
+            size_t close = i + 2;
+            for (int depth = 1; close < end; ++close) {
+                Token::Type inner = nodes[close]->value.type();
+                if (inner == Token::Type::LBracket)
+                    depth++;
+                if (inner == Token::Type::RBracket && --depth == 0)
+                    break;
+            }
+            if (close == end)
+                return false;
+
+            out.push_back(node);
+            out.push_back(nodes[i + 1]);
+            if (!foldRange(nodes, i + 2, close, out))
+                return false;
+            out.push_back(nodes[close]);
+            stack.push_back({term.begin, out.size()});
+            i = close;
+            continue;
+        } else if (isBinaryOperator(type)) {
+            if (!foldOperator(node, stack, out))
+                return false;
+            continue;
+        } else if (type == Token::Type::BooleanNot) {
+            if (stack.empty())
+                return false;
+            Term &operand = stack.back();
+            if (operand.constant) {
+                note(node->value, "folded !" + to_string(operand.value) +
+                                      " into " + to_string(!operand.value));
+                operand.value = !operand.value;
+                out.back() = literal(operand.value, node->value);
+            } else {
+                out.push_back(node);
+                operand.end = out.size();
+            }
+            continue;
+        } else if (type == Token::Type::AssignmentOperator) {
+            if (stack.size() < 2)
+                return false;
+            stack.pop_back();
+            stack.back().constant = false;
+            out.push_back(node);
+            stack.back().end = out.size();
+            continue;
+        }
+
+        // identifiers, strings and characters are kept as they are
+        out.push_back(node);
+        stack.push_back(term);
+    }
+    return true;
+}
+
+bool ASTOptimizer::foldOperator(NodePtr op, vector<Term> &stack,
+                                vector<NodePtr> &out) {
+    if (stack.size() < 2)
+        return false;
+    Term right = stack.back();
+    stack.pop_back();
+    Term left = stack.back();
+    stack.pop_back();
+
+    Token::Type type = op->value.type();
+    const string &symbol = op->value.value();
+    int value;
+
+    if (left.constant && right.constant &&
+        evaluate(type, left.value, right.value, value)) {
+        note(op->value, "folded " + to_string(left.value) + " " + symbol +
+                            " " + to_string(right.value) + " into " +
+                            to_string(value));
+        out.resize(left.begin);
+        out.push_back(literal(value, op->value));
+        stack.push_back({left.begin, out.size(), true, value});
+        return true;
+    }
+
+    // x + 0, x - 0, x * 1, x / 1, x ^ 1
+    if (right.constant &&
+        ((right.value == 0 &&
+          (type == Token::Type::Plus || type == Token::Type::Minus)) ||
+         (right.value == 1 &&
+          (type == Token::Type::Asterisk || type == Token::Type::Slash ||
+           type == Token::Type::Caret)))) {
+        note(op->value, "removed " + symbol + " " + to_string(right.value));
+        out.resize(right.begin);
+        stack.push_back(left);
+        return true;
+    }
+
+    // 0 + x, 1 * x
+    if (left.constant &&
+        ((left.value == 0 && type == Token::Type::Plus) ||
+         (left.value == 1 && type == Token::Type::Asterisk))) {
+        note(op->value, "removed " + to_string(left.value) + " " + symbol);
+        out.erase(out.begin() + left.begin, out.begin() + left.end);
+        stack.push_back({left.begin, out.size()});
+        return true;
+    }
+
+    // x ^ 2 is computed through pow, x * x isn't
+    if (type == Token::Type::Caret && right.constant && right.value == 2 &&
+        left.end - left.begin == 1 &&
+        out[left.begin]->value.type() == Token::Type::Identifier) {
+        const Token &base = out[left.begin]->value;
+        note(op->value, "replaced " + base.value() + " ^ 2 with " +
+                            base.value() + " * " + base.value());
+        out.resize(right.begin);
+        out.push_back(arena.create(base));
+        out.push_back(arena.create(
+            Token(Token::Type::Asterisk, "*", op->value.lineNum())));
+        stack.push_back({left.begin, out.size()});
+        return true;
+    }
+
+    out.push_back(op);
+    stack.push_back({left.begin, out.size()});
+    return true;
+}
+
+// Removes 'row' if it is an IF or a WHILE whose condition is a constant,
+// splicing the statements of the branch that is always taken in its place.
+// Declarations are kept wherever they were, the interpreter pairs each with
+// its symbol table. True if the statement was removed.
+bool ASTOptimizer::removeConstantBranch(NodePtr previous, NodePtr row) {
+    Node::Type type = row->getSemanticType();
+    int condition;
+    if ((type != Node::Type::IF && type != Node::Type::WHILE) ||
+        !constantCondition(row, condition))
+        return false;
+    if (type == Node::Type::WHILE && condition)
+        return false; // an endless loop stays one
+
+    // the statements to keep are [keepBegin, keepEnd)
+    NodePtr keepBegin = nullptr, keepEnd = nullptr;
+    NodePtr after = skipStatement(row);
+    string text = type == Node::Type::IF ? "removed if" : "removed while";
+    text += condition ? ", its condition is always true"
+                      : ", its condition is always false";
+
+    if (type == Node::Type::IF) {
+        NodePtr body = nextRow(row);
+        NodePtr next = skipStatement(body);
+        bool hasElse = next && next->getSemanticType() == Node::Type::ELSE;
+        if (!condition && hasElse) {
+            body = nextRow(next);
+            text += ", kept its else branch";
+        } else if (condition && hasElse) {
+            text += ", dropped its else branch";
+        }
+
+        if (condition || hasElse) {
+            if (body && body->getSemanticType() == Node::Type::BEGIN_BLOCK) {
+                keepBegin = nextRow(body);
+                keepEnd = matchingEnd(body);
+            } else {
+                keepBegin = body;
+                keepEnd = skipStatement(body);
+            }
+        }
+    }
+    if (!after)
+        return false;
+
+    vector<NodePtr> kept;
+    bool keeping = false;
+    for (NodePtr r = row; r != after; r = nextRow(r)) {
+        if (!r)
+            return false; // the statement has no end
+        if (r == keepEnd)
+            keeping = false;
+        if (r == keepBegin && keepBegin != keepEnd)
+            keeping = true;
+        if (keeping || r->getSemanticType() == Node::Type::DECLARATION)
+            kept.push_back(r);
+    }
+
+    NodePtr link = lastNode(previous);
+    for (NodePtr r : kept) {
+        link->leftChild = r;
+        link = lastNode(r);
+    }
+    link->leftChild = after;
+
+    note(row->value, text);
+    return true;
+}
+
+NodePtr ASTOptimizer::literal(int value, const Token &at) {
+    return arena.create(
+        Token(Token::Type::Integer, to_string(value), at.lineNum()));
+}
+
+void ASTOptimizer::note(const Token &at, const string &text) {
+    changes.push_back("line " + to_string(at.lineNum()) + ": " + text);
+}
@@ -0,0 +1,60 @@
+#ifndef ASTOPTIMIZER_H
+#define ASTOPTIMIZER_H
+
+#include "../Node/Node.h"
+#include "../Node/NodeArena.h"
+#include "../SymbolTable/SymbolTable.h"
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Optimization level of every program compiled by this process, set by -O
+extern int _globalOptLevel;
+
+// Rewrites the AST after it is parsed, before anything runs it:
+//
+//   -O1  folds operators whose operands are all constants, drops x + 0,
+//        x - 0, x * 1, x / 1 and x ^ 1, and turns x ^ 2 into x * x
+//   -O2  also removes IF and WHILE statements whose condition is constant,
+//        keeping only the branch that is always taken, and then whatever
+//        DeadCodeEliminator finds main never uses
+//
+// Rows that call a function are left alone, so a call is never dropped or
+// run a different number of times. Every rewrite is described in report(),
+// which the ast option prints after the tree.
+class ASTOptimizer {
+  public:
+    ASTOptimizer(NodeArena &arena, SymTblPtr &symTableRoot, int level);
+
+    void optimize(NodePtr &astRoot);
+
+    const std::vector<std::string> &report() const { return changes; }
+
+  private:
+    // One operand of the postfix row being rewritten: the nodes [begin, end)
+    // of the new row, and its value when it is a constant
+    struct Term {
+        size_t begin;
+        size_t end;
+        bool constant = false;
+        int value = 0;
+    };
+
+    bool foldRow(NodePtr row);
+    bool foldRange(const std::vector<NodePtr> &nodes, size_t begin,
+                   size_t end, std::vector<NodePtr> &out);
+    bool foldOperator(NodePtr op, std::vector<Term> &stack,
+                      std::vector<NodePtr> &out);
+    bool removeConstantBranch(NodePtr previous, NodePtr row);
+
+    NodePtr literal(int value, const Token &at);
+    void note(const Token &at, const std::string &text);
+
+    NodeArena &arena; // owns the nodes rewrites add
+    SymTblPtr &symTableRoot;
+    int level;
+    std::unordered_set<int> functionNames; // interned
+    std::vector<std::string> changes;
+};
+
+#endif // ASTOPTIMIZER_H
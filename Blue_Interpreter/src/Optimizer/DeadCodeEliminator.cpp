@@ -0,0 +1,241 @@
+#include "DeadCodeEliminator.h"
+#include "Rows.h"
+
+#include <unordered_map>
+
+using namespace std;
+
+DeadCodeEliminator::DeadCodeEliminator(NodePtr &astRoot,
+                                       SymTblPtr &symTableRoot)
+    : astRoot(astRoot), symTableRoot(symTableRoot) {
+    for (NodePtr row = astRoot; row; row = nextRow(row))
+        rows.push_back(row);
+    removed.assign(rows.size(), false);
+}
+
+void DeadCodeEliminator::eliminate(vector<string> &report) {
+    findFunctions();
+
+    size_t main = functions.size();
+    for (size_t i = 0; i < functions.size(); ++i)
+        if (functions[i].table->GetName() == "main")
+            main = i;
+    if (main == functions.size())
+        return;
+    markReachable(main);
+
+    size_t noted = report.size();
+    for (const Function &function : functions) {
+        if (function.reachable) {
+            removeAfterReturns(function, report);
+            continue;
+        }
+
+        for (size_t i = function.first; i <= function.last; ++i)
+            removed[i] = true;
+        removedScopes.insert(function.table->GetScope());
+
+        bool isFunction =
+            function.table->GetIdType() == SymbolTable::IDType::function;
+        report.push_back(
+            "line " + to_string(rows[function.first]->value.lineNum()) +
+            ": removed " + (isFunction ? "function " : "procedure ") +
+            function.table->GetName() + ", main never calls it");
+    }
+    removeUnusedGlobals(report);
+
+    if (report.size() > noted)
+        relink();
+}
+
+// Pairs each function or procedure declared in the AST with its symbol
+// table, in order, the way SymbolResolver does
+void DeadCodeEliminator::findFunctions() {
+    SymTblPtr table = symTableRoot;
+
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const string &value = rows[i]->value.value();
+        if (rows[i]->getSemanticType() != Node::Type::DECLARATION ||
+            (value != "function" && value != "procedure"))
+            continue;
+
+        while (table &&
+               table->GetIdType() != SymbolTable::IDType::function &&
+               table->GetIdType() != SymbolTable::IDType::procedure)
+            table = table->GetNextTable();
+
+        // the body is the block that follows
+        size_t last = i + 1;
+        while (last < rows.size() &&
+               rows[last]->getSemanticType() != Node::Type::BEGIN_BLOCK)
+            last++;
+        for (int depth = 0; last < rows.size(); ++last) {
+            Node::Type type = rows[last]->getSemanticType();
+            if (type == Node::Type::BEGIN_BLOCK)
+                depth++;
+            if (type == Node::Type::END_BLOCK && --depth == 0)
+                break;
+        }
+
+        if (!table || last == rows.size()) {
+            functions.clear(); // not a program we can take apart safely
+            return;
+        }
+        functions.push_back({table, i, last});
+        table = table->GetNextTable();
+        i = last;
+    }
+}
+
+void DeadCodeEliminator::markReachable(size_t main) {
+    unordered_map<int, size_t> byName;
+    for (size_t i = 0; i < functions.size(); ++i)
+        byName[functions[i].table->GetNameId()] = i;
+
+    vector<size_t> pending{main};
+    functions[main].reachable = true;
+    while (!pending.empty()) {
+        const Function &function = functions[pending.back()];
+        pending.pop_back();
+
+        for (size_t i = function.first; i <= function.last; ++i) {
+            // a CALL row names the callee itself, calls in expressions are
+            // identifiers
+            for (NodePtr node = rows[i]; node; node = node->Right()) {
+                if (node->value.type() != Token::Type::Identifier &&
+                    !(node == rows[i] &&
+                      node->getSemanticType() == Node::Type::CALL))
+                    continue;
+
+                auto callee = byName.find(node->value.id());
+                if (callee != byName.end() &&
+                    !functions[callee->second].reachable) {
+                    functions[callee->second].reachable = true;
+                    pending.push_back(callee->second);
+                }
+            }
+        }
+    }
+}
+
+void DeadCodeEliminator::removeAfterReturns(const Function &function,
+                                            vector<string> &report) {
+    for (size_t i = function.first + 1; i < function.last; ++i) {
+        if (rows[i]->getSemanticType() != Node::Type::RETURN)
+            continue;
+
+        // a return that is the whole body of an if or a loop only ends that
+        switch (rows[i - 1]->getSemanticType()) {
+        case Node::Type::IF:
+        case Node::Type::ELSE:
+        case Node::Type::WHILE:
+        case Node::Type::ForExpression3:
+            continue;
+        default:
+            break;
+        }
+
+        // the END_BLOCK of the block holding the return
+        size_t end = i + 1;
+        for (int depth = 0; end < function.last; ++end) {
+            Node::Type type = rows[end]->getSemanticType();
+            if (type == Node::Type::BEGIN_BLOCK)
+                depth++;
+            if (type == Node::Type::END_BLOCK && depth-- == 0)
+                break;
+        }
+
+        int statements = 0;
+        for (NodePtr row = rows[i + 1]; row && row != rows[end];
+             row = skipStatement(row))
+            if (row->getSemanticType() != Node::Type::DECLARATION)
+                statements++;
+
+        for (size_t j = i + 1; j < end; ++j)
+            if (rows[j]->getSemanticType() != Node::Type::DECLARATION)
+                removed[j] = true;
+
+        if (statements > 0)
+            report.push_back("line " + to_string(rows[i]->value.lineNum()) +
+                             ": removed " + to_string(statements) +
+                             (statements == 1 ? " statement" : " statements") +
+                             " after return");
+        i = end;
+    }
+}
+
+void DeadCodeEliminator::removeUnusedGlobals(vector<string> &report) {
+    vector<bool> inFunction(rows.size(), false);
+    for (const Function &function : functions)
+        for (size_t i = function.first; i <= function.last; ++i)
+            inFunction[i] = true;
+
+    unordered_set<int> used;
+    vector<size_t> declarations; // of globals
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (rows[i]->getSemanticType() == Node::Type::DECLARATION) {
+            if (!inFunction[i])
+                declarations.push_back(i);
+            continue;
+        }
+        if (removed[i])
+            continue;
+        for (NodePtr node = rows[i]; node; node = node->Right())
+            if (node->value.type() == Token::Type::Identifier)
+                used.insert(node->value.id());
+    }
+
+    vector<SymTblPtr> globals;
+    for (SymTblPtr table = symTableRoot; table; table = table->GetNextTable())
+        if (table->GetScope() == 0 &&
+            table->GetIdType() == SymbolTable::IDType::datatype)
+            globals.push_back(table);
+    if (globals.size() != declarations.size())
+        return; // the k-th declaration row has to be the k-th global
+
+    for (size_t k = 0; k < globals.size(); ++k) {
+        if (used.count(globals[k]->GetNameId()))
+            continue;
+        removed[declarations[k]] = true;
+        removedTables.insert(globals[k].get());
+        report.push_back("line " +
+                         to_string(rows[declarations[k]]->value.lineNum()) +
+                         ": removed global " + globals[k]->GetName() +
+                         ", nothing uses it");
+    }
+}
+
+// Links the rows and symbol tables that are left back into lists
+void DeadCodeEliminator::relink() {
+    NodePtr previous = nullptr;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (removed[i])
+            continue;
+        if (previous)
+            lastNode(previous)->leftChild = rows[i];
+        else
+            astRoot = rows[i];
+        previous = rows[i];
+    }
+    if (previous)
+        lastNode(previous)->leftChild = nullptr;
+    else
+        astRoot = nullptr;
+
+    SymTblPtr kept = nullptr;
+    for (SymTblPtr table = symTableRoot, next; table; table = next) {
+        next = table->GetNextTable();
+        if (removedScopes.count(table->GetScope()) ||
+            removedTables.count(table.get()))
+            continue;
+        if (kept)
+            kept->SetNextTable(table);
+        else
+            symTableRoot = table;
+        kept = table;
+    }
+    if (kept)
+        kept->SetNextTable(nullptr);
+    else
+        symTableRoot = nullptr;
+}
@@ -0,0 +1,53 @@
+#ifndef DEADCODEELIMINATOR_H
+#define DEADCODEELIMINATOR_H
+
+#include "../Node/Node.h"
+#include "../SymbolTable/SymbolTable.h"
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Removes what a program can never use before it runs, part of -O2:
+//
+//   functions and procedures main can't reach through any chain of calls
+//   globals no remaining statement mentions
+//   statements after a return, up to the end of its block
+//
+// Rows and symbol tables are removed together, so every DECLARATION row
+// still lines up with its table. Declarations inside unreachable statements
+// are kept for the same reason. Nothing is removed from a program without
+// a main.
+class DeadCodeEliminator {
+  public:
+    DeadCodeEliminator(NodePtr &astRoot, SymTblPtr &symTableRoot);
+
+    // Appends one line per removal to 'report'
+    void eliminate(std::vector<std::string> &report);
+
+  private:
+    // A function or procedure: its rows are rows[first, last]
+    struct Function {
+        SymTblPtr table;
+        size_t first;
+        size_t last;
+        bool reachable = false;
+    };
+
+    void findFunctions();
+    void markReachable(size_t main);
+    void removeAfterReturns(const Function &function,
+                            std::vector<std::string> &report);
+    void removeUnusedGlobals(std::vector<std::string> &report);
+    void relink();
+
+    NodePtr &astRoot;
+    SymTblPtr &symTableRoot;
+
+    std::vector<NodePtr> rows; // every row of the program, in order
+    std::vector<bool> removed; // by row
+    std::vector<Function> functions;
+    std::unordered_set<int> removedScopes;
+    std::unordered_set<const SymbolTable *> removedTables;
+};
+
+#endif // DEADCODEELIMINATOR_H
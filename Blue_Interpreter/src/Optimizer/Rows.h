@@ -0,0 +1,56 @@
+#ifndef ROWS_H
+#define ROWS_H
+
+#include "../Node/Node.h"
+
+// Every statement in the AST is a row of right siblings, the next statement
+// hangs off the left child of the last node in the row
+
+inline NodePtr lastNode(NodePtr row) {
+    while (row->Right())
+        row = row->Right();
+    return row;
+}
+
+inline NodePtr nextRow(NodePtr row) {
+    return row ? lastNode(row)->Left() : nullptr;
+}
+
+// END_BLOCK closing the block that starts at 'begin', nullptr if it has none
+inline NodePtr matchingEnd(NodePtr begin) {
+    int depth = 0;
+    for (NodePtr row = begin; row; row = nextRow(row)) {
+        if (row->getSemanticType() == Node::Type::BEGIN_BLOCK)
+            depth++;
+        if (row->getSemanticType() == Node::Type::END_BLOCK && --depth == 0)
+            return row;
+    }
+    return nullptr;
+}
+
+// The row after the statement starting at 'row', the way BytecodeCompiler
+// walks statements
+inline NodePtr skipStatement(NodePtr row) {
+    if (!row)
+        return nullptr;
+
+    switch (row->getSemanticType()) {
+    case Node::Type::IF: {
+        NodePtr next = skipStatement(nextRow(row));
+        if (next && next->getSemanticType() == Node::Type::ELSE)
+            next = skipStatement(nextRow(next));
+        return next;
+    }
+    case Node::Type::WHILE:
+        return skipStatement(nextRow(row));
+    case Node::Type::FOR:
+        // the three For_Expression rows, then the body
+        return skipStatement(nextRow(nextRow(nextRow(nextRow(row)))));
+    case Node::Type::BEGIN_BLOCK:
+        return nextRow(matchingEnd(row));
+    default:
+        return nextRow(row);
+    }
+}
+
+#endif // ROWS_H
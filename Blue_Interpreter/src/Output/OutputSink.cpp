@@ -0,0 +1,96 @@
+#include "OutputSink.h"
+
+#include <charconv>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define OUTPUT_POSIX
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+OutputSink _globalOutput;
+
+// Writes a block straight to the FILE's descriptor where there is one, stdio
+// would split it into several writes
+static void writeBlock(FILE *file, const char *data, size_t size) {
+    fflush(file); // anything already printed through the FILE goes first
+#ifdef OUTPUT_POSIX
+    int fd = fileno(file);
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        data += written;
+        size -= written;
+    }
+#else
+    fwrite(data, 1, size, file);
+    fflush(file);
+#endif
+}
+
+OutputSink::OutputSink(FILE *file, size_t capacity)
+    : buffer(new char[capacity]), capacity(capacity), file(file) {}
+
+void OutputSink::write(const char *text, size_t size) {
+    if (size > capacity - used) {
+        flush();
+        // too big to buffer, pass it on as it is
+        if (size >= capacity) {
+            if (captured)
+                captured->append(text, size);
+            else
+                writeBlock(file, text, size);
+            return;
+        }
+    }
+    memcpy(buffer.get() + used, text, size);
+    used += size;
+}
+
+void OutputSink::writeInt(int value) {
+    char digits[16];
+    auto result = to_chars(digits, digits + sizeof(digits), value);
+    write(digits, result.ptr - digits);
+}
+
+void OutputSink::writeCharArray(const int *values, int size) {
+    for (int i = 0; i < size; i++) {
+        if (values[i] == '\\') {
+            i++;
+            if (i < size && values[i] == 'x') {
+                i++;
+                if (i < size && values[i] == '0') {
+                    break;
+                }
+            }
+        }
+        if (i < size && values[i] != 0)
+            put(static_cast<char>(values[i]));
+    }
+}
+
+void OutputSink::flush() {
+    if (captured)
+        captured->append(buffer.get(), used);
+    else if (used > 0)
+        writeBlock(file, buffer.get(), used);
+    used = 0;
+}
+
+void OutputSink::writeTo(FILE *file) {
+    flush();
+    this->file = file;
+    captured = nullptr;
+}
+
+void OutputSink::captureInto(string *text) {
+    flush();
+    captured = text;
+}
@@ -0,0 +1,54 @@
+#ifndef OUTPUTSINK_H
+#define OUTPUTSINK_H
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Collects what a running program prints in one large buffer that is handed
+// on when it fills up or is flushed, instead of going through std::cout a
+// value or a character at a time. Output goes to a FILE, stdout unless told
+// otherwise, or is captured into a string.
+//
+// The buffer is flushed when a program finishes, before an error is reported
+// and when the sink is destroyed, so output still comes before the error
+// message that follows it.
+class OutputSink {
+  public:
+    explicit OutputSink(FILE *file = stdout, size_t capacity = 64 * 1024);
+    ~OutputSink() { flush(); }
+    OutputSink(const OutputSink &) = delete;
+    OutputSink &operator=(const OutputSink &) = delete;
+
+    void put(char c) {
+        if (used == capacity)
+            flush();
+        buffer[used++] = c;
+    }
+    void write(const char *text, size_t size);
+    void write(std::string_view text) { write(text.data(), text.size()); }
+    void writeInt(int value);
+    // The characters of a char array, up to a "\x0" terminator
+    void writeCharArray(const int *values, int size);
+
+    // Hands on everything buffered so far
+    void flush();
+
+    // Where output goes from now on, anything pending goes to the old target
+    void writeTo(FILE *file);
+    void captureInto(std::string *text);
+
+  private:
+    std::unique_ptr<char[]> buffer;
+    size_t capacity;
+    size_t used = 0;
+
+    FILE *file;
+    std::string *captured = nullptr;
+};
+
+// Output of the interpreter and the VM
+extern OutputSink _globalOutput;
+
+#endif // OUTPUTSINK_H
@@ -53,11 +53,6 @@ void OutPutGenerator::PrintAST(NodePtr &root) {
 }
 
 void OutPutGenerator::PrintCST(NodePtr &root) {
-    ofstream output("Concrete_SyntaxTree_Output.txt");
-    if (!output.is_open()) {
-                _globalErrorHandler.handle(26, 0);
-
-    }
     if (root == nullptr) {
         cout << "Tree is empty." << endl;
         return;
@@ -93,7 +88,6 @@ void OutPutGenerator::PrintCST(NodePtr &root) {
             break;
         }
     }
-    output.close();
 }
 
 void printATable(SymTblPtr &table) {
@@ -143,3 +137,107 @@ void OutPutGenerator::PrintSymbolTables(SymTblPtr &root) {
         printParameterList(prmLists.at(i));
     }
 }
+
+
+void OutPutGenerator::PrintBytecode(const BytecodeProgram &program) {
+    for (int i = 0; i < program.code.size(); i++) {
+        // label the first instruction of each function or procedure
+        for (const auto &function : program.functions) {
+            if (function.entry == i)
+                cout << endl << function.name << ":" << endl;
+        }
+
+        const Instruction &ins = program.code[i];
+        cout << std::setw(6) << std::right << i << "  " << std::setw(22)
+             << std::left << BytecodeProgram::opCodeToString(ins.op)
+             << std::setw(6) << ins.a << std::setw(6) << ins.b << "line "
+             << program.lines[i];
+
+        if (ins.op == OpCode::PRINT_TEXT)
+            cout << "  \"" << program.strings[ins.a] << "\"";
+        else if (BytecodeProgram::isJump(ins.op) && isSuperinstruction(ins.op))
+            cout << "  " << BytecodeProgram::opCodeToString(ins.cond)
+                 << ", else to " << ins.c;
+        else if (ins.op == OpCode::STORE_GLOBAL_ELEM_AT ||
+                 ins.op == OpCode::STORE_LOCAL_ELEM_AT)
+            cout << "  index in local " << ins.c;
+        cout << endl;
+    }
+}
+
+void OutPutGenerator::PrintRegisterCode(const RegisterProgram &program) {
+    for (int i = 0; i < program.code.size(); i++) {
+        // label the first instruction of each function or procedure
+        for (const auto &function : program.functions) {
+            if (function.entry == i)
+                cout << endl
+                     << function.name << ":  (" << function.frameSize
+                     << " slots)" << endl;
+        }
+
+        // the operands each instruction reads or writes
+        const RegInstruction &ins = program.code[i];
+        vector<Operand> operands;
+        switch (ins.op) {
+        case RegOp::MOVE:
+        case RegOp::NOT:
+        case RegOp::CALL:
+            operands = {ins.dst, ins.a};
+            break;
+        case RegOp::JUMP_IF_FALSE:
+        case RegOp::RETURN:
+        case RegOp::PRINT_INT:
+        case RegOp::PRINT_STR:
+            operands = {ins.a};
+            break;
+        case RegOp::BRANCH:
+            operands = {ins.a, ins.b};
+            break;
+        case RegOp::JUMP:
+        case RegOp::PRINT_TEXT:
+        case RegOp::EXIT:
+        case RegOp::HALT:
+            break;
+        default:
+            operands = {ins.dst, ins.a, ins.b};
+        }
+
+        cout << std::setw(6) << std::right << i << "  " << std::setw(15)
+             << std::left << RegisterProgram::opToString(ins.op);
+        for (int slot = 0; slot < 3; slot++)
+            cout << std::setw(8)
+                 << (slot < operands.size()
+                         ? program.operandToString(operands[slot])
+                         : "");
+        cout << "line " << program.lines[i];
+
+        if (ins.op == RegOp::JUMP || ins.op == RegOp::JUMP_IF_FALSE)
+            cout << "  to " << ins.extra;
+        else if (ins.op == RegOp::BRANCH)
+            cout << "  " << BytecodeProgram::opCodeToString(ins.cond)
+                 << ", else to " << ins.extra;
+        else if (ins.op == RegOp::CALL)
+            cout << "  " << program.functions[ins.extra].name;
+        else if (ins.op == RegOp::PRINT_TEXT)
+            cout << "  \"" << program.strings[ins.extra] << "\"";
+        else if (ins.op == RegOp::LOAD_ELEM || ins.op == RegOp::STORE_ELEM ||
+                 ins.op == RegOp::PRINT_STR)
+            cout << "  size " << ins.extra;
+        else if (ins.op == RegOp::EXIT)
+            cout << "  status " << ins.extra;
+        cout << endl;
+    }
+}
+
+// What the optimizer changed, after the tree it changed
+void OutPutGenerator::PrintOptimizations(
+    int level, const std::vector<std::string> &changes) {
+    cout << endl << "Optimizations at -O" << level << ":";
+    if (changes.empty())
+        cout << " none";
+    cout << endl;
+    for (const auto &change : changes)
+        cout << "  " << change << endl;
+}
+
+
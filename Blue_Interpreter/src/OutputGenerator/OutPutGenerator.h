@@ -1,5 +1,7 @@
 #ifndef OUTPUTGENERATOR_H
 #define OUTPUTGENERATOR_H
+#include "../Bytecode/Bytecode.h"
+#include "../Bytecode/RegisterProgram.h"
 #include "../CST/ConcreteSyntaxTree.h"
 #include "../SymbolTable/SymbolTable.h"
 #include <fstream>
@@ -10,6 +12,12 @@ class OutPutGenerator {
     void PrintAST(const NodePtr &root);
 
     void PrintSymbolTables(SymTblPtr &root);
+
+    void PrintBytecode(const BytecodeProgram &program);
+    void PrintRegisterCode(const RegisterProgram &program);
+
+    void PrintOptimizations(int level,
+                            const std::vector<std::string> &changes);
 };
 
-#endif // OUTPUTGENERATOR_H
\ No newline at end of file
+#endif // OUTPUTGENERATOR_H
\ No newline at end of file
@@ -0,0 +1,314 @@
+#include "Server.h"
+#include "../Driver/Driver.h"
+#include "../Limits/ExecutionLimits.h"
+#include "../Output/OutputSink.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SERVER_POSIX
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Longest accepted request line and program
+static const size_t MaxHeaderSize = 64;
+static const size_t MaxSourceSize = 16 * 1024 * 1024;
+
+// A child still running this long after the time limit is killed. Programs
+// stop themselves at the limit, this catches the stages before them.
+static const unsigned TimeLimitGrace = 1000; // milliseconds
+
+Server::Server(bool fusedLexer, const string &cacheDirectory)
+    : fusedLexer(fusedLexer), cache(cacheDirectory) {}
+
+#ifdef SERVER_POSIX
+
+static bool readAll(int fd, char *data, size_t size) {
+    while (size > 0) {
+        ssize_t count = read(fd, data, size);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            return false;
+        data += count;
+        size -= count;
+    }
+    return true;
+}
+
+static bool writeAll(int fd, const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t count = write(fd, data, size);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            return false;
+        data += count;
+        size -= count;
+    }
+    return true;
+}
+
+static size_t capturedSize(FILE *capture) {
+    struct stat info;
+    return fstat(fileno(capture), &info) == 0 ? info.st_size : 0;
+}
+
+int Server::serveStream(int in, int out) {
+    // a client hanging up mid reply shouldn't take the server with it
+    signal(SIGPIPE, SIG_IGN);
+
+    // opened here rather than in the constructor so each connection of a
+    // socket server rewinds files of its own
+    capturedOut = tmpfile();
+    capturedErr = tmpfile();
+    capturedImage = tmpfile();
+    if (!capturedOut || !capturedErr || !capturedImage) {
+        cerr << "Server: can't create files for program output" << endl;
+        return 1;
+    }
+
+    int result = 0;
+    string option, source;
+    try {
+        while (readRequest(in, option, source)) {
+            int status = runRequest(option, source);
+            if (status < 0 || !writeReply(out, status)) {
+                result = 1;
+                break;
+            }
+        }
+    } catch (const std::runtime_error &error) {
+        // the stream can't be followed past a bad request
+        cerr << "Server: " << error.what() << endl;
+        result = 1;
+    }
+
+    fclose(capturedOut);
+    fclose(capturedErr);
+    fclose(capturedImage);
+    capturedOut = capturedErr = capturedImage = nullptr;
+    return result;
+}
+
+int Server::serveSocket(const string &path) {
+    sockaddr_un address{};
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        cerr << "Server: invalid socket path " << path << endl;
+        return 1;
+    }
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, path.size());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path.c_str()); // left behind by a server that didn't shut down
+    if (listener < 0 ||
+        bind(listener, reinterpret_cast<sockaddr *>(&address),
+             sizeof(address)) < 0 ||
+        listen(listener, 16) < 0) {
+        perror("Server");
+        return 1;
+    }
+
+    for (;;) {
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("Server");
+            return 1;
+        }
+
+        // collect connections that have finished since the last one
+        while (waitpid(-1, nullptr, WNOHANG) > 0)
+            ;
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(listener);
+            exit(serveStream(connection, connection));
+        }
+        if (pid < 0)
+            perror("Server");
+        close(connection);
+    }
+}
+
+// False once 'in' is closed between requests, throws if a request is cut
+// short or malformed
+bool Server::readRequest(int in, string &option, string &source) {
+    string header;
+    char c;
+    for (;;) {
+        ssize_t count = read(in, &c, 1);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0) {
+            if (!header.empty())
+                throw runtime_error("request ended inside its header");
+            return false;
+        }
+        if (c == '\n')
+            break;
+        if (header.size() == MaxHeaderSize)
+            throw runtime_error("request header too long");
+        header += c;
+    }
+
+    size_t space = header.find(' ');
+    option = header.substr(0, space);
+    bool valid = space != string::npos && !option.empty();
+    for (char letter : option)
+        valid = valid && (isalpha(static_cast<unsigned char>(letter)) ||
+                          letter == '-');
+
+    char *end = nullptr;
+    unsigned long long size =
+        valid ? strtoull(header.c_str() + space + 1, &end, 10) : 0;
+    if (!valid || end == header.c_str() + space + 1 || *end != '\0')
+        throw runtime_error("malformed request header: " + header);
+    if (size > MaxSourceSize)
+        throw runtime_error("program of " + to_string(size) +
+                            " bytes is too large");
+
+    source.resize(size);
+    if (!readAll(in, &source[0], size))
+        throw runtime_error("request ended inside its program");
+    return true;
+}
+
+// Runs one program in a child with its output going to the capture files,
+// returns its exit status or -1 if it couldn't be started
+int Server::runRequest(const string &option, const string &source) {
+    ProgramImage::Kind kind;
+    bool cacheable = ProgramImage::kindFor(option, kind);
+    const string *image = cacheable ? cache.find(kind, source) : nullptr;
+
+    for (FILE *capture : {capturedOut, capturedErr, capturedImage}) {
+        if (ftruncate(fileno(capture), 0) < 0 ||
+            lseek(fileno(capture), 0, SEEK_SET) < 0) {
+            perror("Server");
+            return -1;
+        }
+    }
+
+    // nothing buffered here may be written out a second time by the child
+    _globalOutput.flush();
+    cout.flush();
+    cerr.flush();
+    fflush(nullptr);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("Server");
+        return -1;
+    }
+
+    if (pid == 0) {
+        // the whole request, tokenizing and parsing too, gets the time limit
+        if (_globalLimits.maxMilliseconds > 0) {
+            unsigned limit = _globalLimits.maxMilliseconds + TimeLimitGrace;
+            itimerval timer{};
+            timer.it_value.tv_sec = limit / 1000;
+            timer.it_value.tv_usec = limit % 1000 * 1000;
+            setitimer(ITIMER_REAL, &timer, nullptr);
+        }
+
+        int nothing = open("/dev/null", O_RDONLY);
+        if (nothing >= 0)
+            dup2(nothing, 0);
+        dup2(fileno(capturedOut), 1);
+        dup2(fileno(capturedErr), 2);
+
+        if (image)
+            exit(runImage(*image, option));
+
+        // written out before the program runs, which may never return
+        int imageFile = fileno(capturedImage);
+        ImageSink compiled = [imageFile](const string &image) {
+            writeAll(imageFile, image.data(), image.size());
+        };
+        exit(runSource(source, option, fusedLexer,
+                       cacheable ? compiled : nullptr));
+    }
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            perror("Server");
+            return -1;
+        }
+    }
+
+    // store checks the image is whole before keeping it
+    size_t imageSize = capturedSize(capturedImage);
+    if (cacheable && !image && imageSize > 0) {
+        string compiled(imageSize, '\0');
+        if (pread(fileno(capturedImage), &compiled[0], imageSize, 0) ==
+            static_cast<ssize_t>(imageSize))
+            cache.store(kind, source, move(compiled));
+    }
+
+    if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) {
+        string error = "Error 40: Execution limit exceeded (time " +
+                       to_string(_globalLimits.maxMilliseconds) + " ms)\n";
+        int errFile = fileno(capturedErr);
+        if (lseek(errFile, 0, SEEK_END) < 0 ||
+            !writeAll(errFile, error.data(), error.size()))
+            perror("Server");
+        return 40;
+    }
+    if (WIFSIGNALED(status))
+        return 128 + WTERMSIG(status);
+    return WEXITSTATUS(status);
+}
+
+bool Server::writeReply(int out, int status) {
+    size_t outSize = capturedSize(capturedOut);
+    size_t errSize = capturedSize(capturedErr);
+
+    string header = to_string(status) + " " + to_string(outSize) + " " +
+                    to_string(errSize) + "\n";
+    if (!writeAll(out, header.data(), header.size()))
+        return false;
+
+    char chunk[64 * 1024];
+    for (FILE *capture : {capturedOut, capturedErr}) {
+        size_t size = capturedSize(capture);
+        for (off_t offset = 0; size > 0;) {
+            ssize_t count = pread(fileno(capture), chunk,
+                                  min(size, sizeof(chunk)), offset);
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count <= 0 || !writeAll(out, chunk, count))
+                return false;
+            offset += count;
+            size -= count;
+        }
+    }
+    return true;
+}
+
+#else
+
+int Server::serveStream(int, int) {
+    cerr << "Server mode needs fork, which this system doesn't have" << endl;
+    return 1;
+}
+
+int Server::serveSocket(const string &path) { return serveStream(0, 1); }
+
+#endif
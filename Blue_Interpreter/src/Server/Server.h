@@ -0,0 +1,49 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "../Cache/CompileCache.h"
+#include <cstdio>
+#include <string>
+
+// Keeps one interpreter process warm so callers don't start a new one for
+// every program.
+//
+// A request is a line "<option> <length>\n" followed by <length> bytes of
+// source. Each reply is a line "<status> <stdout length> <stderr length>\n"
+// followed by the program's stdout and then its stderr, where <status> is
+// the exit code a run of its own would have had, or 128 + the signal that
+// ended it.
+//
+// Every program runs in a child forked from the server: the error handler
+// ends the process on the first error and the string pool would otherwise
+// keep growing from one program to the next. The child hands the image of
+// each program it compiles back to the server, which keeps it in a
+// CompileCache so the program is only executed when it comes again. Each
+// stream has a cache of its own, so clients of a socket server should keep
+// their connections open; a cache directory is shared by all of them.
+class Server {
+  public:
+    explicit Server(bool fusedLexer, const std::string &cacheDirectory = "");
+
+    // Answers requests read from 'in' until it is closed, replying on 'out'
+    int serveStream(int in, int out);
+
+    // Accepts connections on a Unix socket, each served as a stream by a
+    // process of its own so connections don't wait on each other
+    int serveSocket(const std::string &path);
+
+  private:
+    bool readRequest(int in, std::string &option, std::string &source);
+    int runRequest(const std::string &option, const std::string &source);
+    bool writeReply(int out, int status);
+
+    bool fusedLexer;
+    CompileCache cache;
+
+    // What the child wrote to stdout and stderr, emptied before each request
+    FILE *capturedOut = nullptr;
+    FILE *capturedErr = nullptr;
+    FILE *capturedImage = nullptr; // image of the program the child compiled
+};
+
+#endif // SERVER_H
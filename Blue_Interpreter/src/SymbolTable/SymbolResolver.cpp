@@ -0,0 +1,84 @@
+#include "SymbolResolver.h"
+
+SymbolResolver::SymbolResolver(const SymTblPtr &symTblRoot) {
+    frames.emplace_back(); // frame 0 holds the globals
+
+    for (SymTblPtr table = symTblRoot; table; table = table->GetNextTable()) {
+        int scope = table->GetScope();
+        if (scope >= frames.size())
+            frames.resize(scope + 1);
+        FrameLayout &layout = frames[scope];
+
+        if (table->GetIdType() == SymbolTable::IDType::function ||
+            table->GetIdType() == SymbolTable::IDType::procedure) {
+            layout.owner = table->GetName();
+            layout.isFunction =
+                table->GetIdType() == SymbolTable::IDType::function;
+            functionFrames[table->GetName()] = scope;
+            functionOrder.push_back(scope);
+            continue;
+        }
+
+        int size = table->isArray() ? table->GetArraySize() : 1;
+
+        if (table->GetIdType() == SymbolTable::IDType::parameterList)
+            layout.paramSlots.push_back(layout.size);
+
+        layout.variables[table->GetNameId()] = {scope, layout.size, size,
+                                              table->isArray(),
+                                              table->GetDataType()};
+        layout.size += size;
+    }
+}
+
+// Every statement in the AST is a row of right siblings, the next statement
+// hangs off the left child of the last node in the row
+static NodePtr nextRow(NodePtr row) {
+    while (row->Right())
+        row = row->Right();
+    return row->Left();
+}
+
+void SymbolResolver::resolve(const NodePtr &astRoot) {
+    int functionCount = 0;
+    int currentFrame = 0;
+    int blockDepth = 0;
+
+    for (NodePtr row = astRoot; row; row = nextRow(row)) {
+        Node::Type type = row->getSemanticType();
+        const std::string &value = row->value.value();
+
+        if (type == Node::Type::DECLARATION && blockDepth == 0 &&
+            (value == "function" || value == "procedure")) {
+            currentFrame = functionOrder.at(functionCount++);
+            continue;
+        }
+        if (type == Node::Type::BEGIN_BLOCK) {
+            blockDepth++;
+        } else if (type == Node::Type::END_BLOCK && --blockDepth == 0) {
+            currentFrame = 0; // end of the function body
+        }
+
+        for (NodePtr node = row; node; node = node->Right()) {
+            if (node->value.type() == Token::Type::Identifier)
+                node->binding = lookup(node->value.id(), currentFrame);
+        }
+    }
+}
+
+const SlotBinding *SymbolResolver::lookup(int nameId, int frame) const {
+    auto local = frames[frame].variables.find(nameId);
+    if (local != frames[frame].variables.end())
+        return &local->second;
+
+    auto global = frames[0].variables.find(nameId);
+    if (global != frames[0].variables.end())
+        return &global->second;
+
+    return nullptr;
+}
+
+int SymbolResolver::frameOf(const std::string &name) const {
+    auto function = functionFrames.find(name);
+    return function == functionFrames.end() ? -1 : function->second;
+}
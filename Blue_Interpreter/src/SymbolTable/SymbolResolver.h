@@ -0,0 +1,53 @@
+#ifndef SYMBOLRESOLVER_H
+#define SYMBOLRESOLVER_H
+
+#include "../Node/Node.h"
+#include "SymbolTable.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Storage assigned to a declared variable or parameter
+struct SlotBinding {
+    int frame; // 0 for globals, otherwise the scope of the owning function
+    int slot;  // first slot, arrays occupy 'size' consecutive slots
+    int size;
+    bool isArray;
+    std::string dataType;
+};
+
+// Slots of one frame: the globals, or the parameters and locals of a
+// function or procedure. Computed once, every call pushes a frame of 'size'
+// slots.
+struct FrameLayout {
+    std::string owner; // function or procedure name, empty for globals
+    bool isFunction = false;
+    int size = 0;
+    std::vector<int> paramSlots; // slot of each parameter, in order
+    std::unordered_map<int, SlotBinding> variables; // by interned name
+};
+
+// Runs once after the symbol tables and the AST are built. Lays out every
+// variable in a frame and binds each identifier node in the AST to its slot,
+// so no name lookups are needed while the program runs.
+class SymbolResolver {
+  public:
+    explicit SymbolResolver(const SymTblPtr &symTblRoot);
+
+    void resolve(const NodePtr &astRoot);
+
+    const SlotBinding *lookup(int nameId, int frame) const;
+
+    const FrameLayout &frame(int index) const { return frames.at(index); }
+    int frameCount() const { return static_cast<int>(frames.size()); }
+
+    // Frame of a function or procedure, -1 if there is none with that name
+    int frameOf(const std::string &name) const;
+
+  private:
+    std::vector<FrameLayout> frames;
+    std::unordered_map<std::string, int> functionFrames;
+    std::vector<int> functionOrder; // frames in declaration order
+};
+
+#endif // SYMBOLRESOLVER_H
@@ -1,6 +1,7 @@
 #ifndef SYMBOLTABLE_H
 #define SYMBOLTABLE_H
 
+#include "../Token/StringPool.h"
 #include <iostream>
 #include <memory> // Used for shared_ptr
 #include <vector>
@@ -27,7 +28,8 @@ class SymbolTable {
                 string procOrFuncName = "")
         : _idName(idName), _dataType(dataType), _idtype(idtype), _scope(scope),
           _isArray(isArray), _arraySize(arraySize),
-          _procOrFuncName(procOrFuncName) {}
+          _procOrFuncName(procOrFuncName),
+          _nameId(_globalStringPool.intern(idName)) {}
 
     void SetNextTable(const SymTblPtr &next);
     void setDeclared(const bool dec) {_isDeclared = dec;}
@@ -46,8 +48,9 @@ class SymbolTable {
             _value.at(index) = newVal;
     }
 
-    string GetName() const { return _idName; }
-    string GetDataType() const { return _dataType; }
+    const string &GetName() const { return _idName; }
+    int GetNameId() const { return _nameId; } // interned name
+    const string &GetDataType() const { return _dataType; }
     string GetIsArray() const { return _isArray ? "yes" : "no"; }
     bool isArray() const { return _isArray;}
     vector<int> &GetValue() {return _value;}
@@ -55,7 +58,7 @@ class SymbolTable {
     int GetScope() const { return _scope; }
     SymTblPtr GetNextTable() const { return nextTable; }
     bool GetIsDeclared() const {return _isDeclared; }
-    std::string procOrFuncName() { return _procOrFuncName; }
+    const std::string &procOrFuncName() const { return _procOrFuncName; }
 
 
 
@@ -94,6 +97,7 @@ class SymbolTable {
     bool _isDeclared = false;
     bool _isArray;
     int _arraySize, _scope;
+    int _nameId;
 
     vector<int> _value;
 
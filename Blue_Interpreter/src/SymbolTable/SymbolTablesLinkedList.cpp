@@ -31,7 +31,7 @@ NodePtr SymbolTablesLinkedList::peekNextCstNode() {
     return nullptr;
 }
 
-string SymbolTablesLinkedList::nodeValue(const NodePtr &node) const {
+const string &SymbolTablesLinkedList::nodeValue(const NodePtr &node) const {
     if (!node) {
         string message = "Can't get value of a nullptr in the symbol table";
         _globalErrorHandler.handle(28, 0, message);
@@ -52,37 +52,37 @@ void SymbolTablesLinkedList::addToSymTable(const SymTblPtr &s) {
 }
 
 // Checks for redeclaration of a function or procedure name
-void SymbolTablesLinkedList::checkFuncProcRedeclaration(const string &name,
+void SymbolTablesLinkedList::checkFuncProcRedeclaration(const Token &name,
                                                         const string &type) {
-    for (const auto &existingName : funcProcNames) {
-        if (existingName == name) {
-            _globalErrorHandler.handle(31, 0, name, type);
+    for (int existingName : funcProcNames) {
+        if (existingName == name.id()) {
+            _globalErrorHandler.handle(31, 0, name.value(), type);
         }
     }
-    funcProcNames.push_back(name); // Add the name to the list
+    funcProcNames.push_back(name.id()); // Add the name to the list
 }
 
-bool SymbolTablesLinkedList::checkVariableRedeclaration(const string &varName,
-                                                        int scope,
-                                                        int lineNumber) {
+bool SymbolTablesLinkedList::checkVariableRedeclaration(const Token &varName,
+                                                        int scope) {
+    int lineNumber = varName.lineNum();
     for (const auto &var : variableDeclared) {
-        if (var.first == varName) {
+        if (var.first == varName.id()) {
             // Existing variable is global (scope 0) and the same name.
             if (var.second == 0) {
-                _globalErrorHandler.handle(29, lineNumber, varName);
+                _globalErrorHandler.handle(29, lineNumber, varName.value());
             }
             // If the existing variable has the same scope as the current
             else if (var.second == scope) {
-                _globalErrorHandler.handle(30, lineNumber, varName);
+                _globalErrorHandler.handle(30, lineNumber, varName.value());
             }
             // If trying to define a global variable that's already defined
             if (scope == 0) {
-                _globalErrorHandler.handle(31, lineNumber, varName);
+                _globalErrorHandler.handle(31, lineNumber, varName.value());
             }
         }
     }
     // If no redeclaration is found, add the variable to the tracked
-    variableDeclared.push_back(make_pair(varName, scope));
+    variableDeclared.push_back(make_pair(varName.id(), scope));
     return false; // No redeclaration found
 }
 
@@ -105,7 +105,7 @@ SymTblPtr SymbolTablesLinkedList::parse() {
     currentScope = 0;
 
     while (peekNextCstNode() != nullptr) {
-        string currentNodeValue = nodeValue(curCstNode);
+        const string &currentNodeValue = nodeValue(curCstNode);
         if (isDataType(currentNodeValue)) {
             declarationTable();
         } else if (currentNodeValue == "function") {
@@ -150,11 +150,10 @@ void SymbolTablesLinkedList::declarationTable() {
         }
         anotherDeclaration = false;
         auto varNameNode = getNextCstNode();
-        string varName = nodeValue(varNameNode);
+        const string &varName = nodeValue(varNameNode);
 
         // If no error then it is added to the variableDeclared vector
-        if (checkVariableRedeclaration(varName, currentScope,
-                                       varNameNode->Value().lineNum())) {
+        if (checkVariableRedeclaration(varNameNode->Value(), currentScope)) {
             continue;
         }
         auto [isArray, arraySize] = parseArrayDeclaration();
@@ -175,16 +174,16 @@ void SymbolTablesLinkedList::declarationTable() {
 
 void SymbolTablesLinkedList::functionTable() {
     auto returnTypeNode = getNextCstNode();
-    string returnType = nodeValue(returnTypeNode);
+    const string &returnType = nodeValue(returnTypeNode);
 
     auto functionNameNode = getNextCstNode();
-    string functionName = nodeValue(functionNameNode);
+    const string &functionName = nodeValue(functionNameNode);
 
     // Checks for redeclaration and add sthe name to the list if not already
     // present
-    checkFuncProcRedeclaration(functionName, "function");
+    checkFuncProcRedeclaration(functionNameNode->Value(), "function");
 
-    funcProcNames.push_back(functionName); // Add the function name declaration
+    funcProcNames.push_back(functionNameNode->Value().id()); // Add the function name declaration
 
     auto functionEntry = make_shared<SymbolTable>(
         functionName, returnType, SymbolTable::IDType::function, currentScope);
@@ -200,7 +199,7 @@ void SymbolTablesLinkedList::functionTable() {
         getNextCstNode(); // Move past '{' to start processing the body
     } else {
         int lineNumber = peekNextCstNode()->Value().lineNum();
-        string name = nodeValue(peekNextCstNode());
+        const string &name = nodeValue(peekNextCstNode());
         _globalErrorHandler.handle(6, lineNumber, name);
     }
     while (nodeValue(peekNextCstNode()) !=
@@ -217,11 +216,11 @@ void SymbolTablesLinkedList::functionTable() {
 
 void SymbolTablesLinkedList::procedureTable() {
     auto procedureNameNode = getNextCstNode();
-    string procedureName = nodeValue(procedureNameNode);
+    const string &procedureName = nodeValue(procedureNameNode);
 
     // Checks for redeclaration and add sthe name to the list if not already
     // present
-    checkFuncProcRedeclaration(procedureName, "procedure");
+    checkFuncProcRedeclaration(procedureNameNode->Value(), "procedure");
 
     auto procedureEntry = make_shared<SymbolTable>(
         procedureName, "void", SymbolTable::IDType::procedure, currentScope);
@@ -233,7 +232,7 @@ void SymbolTablesLinkedList::procedureTable() {
         getNextCstNode(); // Move past '(' to start processing the params
     } else {
         int lineNumber = peekNextCstNode()->Value().lineNum();
-        string name = nodeValue(peekNextCstNode());
+        const string &name = nodeValue(peekNextCstNode());
         _globalErrorHandler.handle(12, lineNumber, name);
         return;
     }
@@ -247,7 +246,7 @@ void SymbolTablesLinkedList::procedureTable() {
         getNextCstNode(); // Move past '{' to start processing the body
     } else {
         int lineNumber = peekNextCstNode()->Value().lineNum();
-        string name = nodeValue(peekNextCstNode());
+        const string &name = nodeValue(peekNextCstNode());
         _globalErrorHandler.handle(6, lineNumber, name);
     }
     while (nodeValue(peekNextCstNode()) !=
@@ -270,14 +269,13 @@ void SymbolTablesLinkedList::parseParameters(const string &procOrFuncName) {
     }
     while (nodeValue(peekNextCstNode()) != ")") {
         auto paramTypeNode = getNextCstNode();
-        string paramType = nodeValue(paramTypeNode);
+        const string &paramType = nodeValue(paramTypeNode);
 
         auto paramNameNode = getNextCstNode();
-        string paramName = nodeValue(paramNameNode);
+        const string &paramName = nodeValue(paramNameNode);
 
         // If no error then it is added to the variableDeclared vector
-        if (checkVariableRedeclaration(paramName, currentScope,
-                                       paramNameNode->Value().lineNum())) {
+        if (checkVariableRedeclaration(paramNameNode->Value(), currentScope)) {
             continue;
         }
         auto [isArray, arraySize] = parseArrayDeclaration();
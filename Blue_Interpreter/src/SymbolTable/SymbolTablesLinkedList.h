@@ -21,7 +21,7 @@ class SymbolTablesLinkedList {
     NodePtr getNextCstNode();
     NodePtr peekNextCstNode();
 
-    string nodeValue(const NodePtr &node) const;
+    const string &nodeValue(const NodePtr &node) const;
 
     void addToSymTable(const SymTblPtr &s);
 
@@ -32,9 +32,8 @@ class SymbolTablesLinkedList {
     void parseParameters(const string &procOrFuncName);
 
     // Helper methods for error handling and declaration checks
-    void checkFuncProcRedeclaration(const string &name, const string &type);
-    bool checkVariableRedeclaration(const string &varName, int scope,
-                                    int lineNumber);
+    void checkFuncProcRedeclaration(const Token &name, const string &type);
+    bool checkVariableRedeclaration(const Token &varName, int scope);
     pair<bool, int> parseArrayDeclaration();
 
     // Creating symbol tables for parameter lists for Procedures and Functions
@@ -42,15 +41,15 @@ class SymbolTablesLinkedList {
     void printTables();
 
   private:
-    NodePtr curCstNode;
+    NodePtr curCstNode = nullptr;
     SymTblPtr root, lastTable;
     int currentScope, scopeCount;
 
-    // Store all the defined variables
-    vector<pair<string, int>> variableDeclared;
+    // Store all the defined variables, as interned name and scope
+    vector<pair<int, int>> variableDeclared;
 
-    // Store function/procedure names to check availability
-    vector<string> funcProcNames;
+    // Store function/procedure names to check availability, interned
+    vector<int> funcProcNames;
 };
 
 #endif // SYMBOLTABLESLINKEDLIST_H
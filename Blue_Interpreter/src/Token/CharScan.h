@@ -0,0 +1,204 @@
+#ifndef CHARSCAN_H
+#define CHARSCAN_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CHARSCAN_VECTOR 32
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CHARSCAN_VECTOR 16
+#endif
+
+// Character classes for the Tokenizer's table-driven scanner, and helpers
+// that skip runs of identifier, digit or whitespace characters a whole
+// vector register at a time. Without SSE2 or AVX2 the runs are skipped with
+// the table alone.
+namespace CharScan {
+
+enum Class : uint8_t {
+    OTHER, // not part of any token
+    SPACE,
+    NEWLINE,
+    ALPHA,
+    DIGIT,
+    UNDERSCORE,
+    SIGN,     // '+' or '-', a unary sign or an operator
+    QUOTE,    // '"' or '\''
+    PUNCT,    // always a token of its own
+    RELATION, // '<', '>', '!' or '=', may be followed by '='
+    LOGICAL,  // '&' or '|', a token only when doubled
+};
+
+struct Entry {
+    Class kind = OTHER;
+    bool endsInteger = false; // may directly follow an integer literal
+};
+
+constexpr std::array<Entry, 256> makeTable() {
+    std::array<Entry, 256> table{};
+    for (int c = 'a'; c <= 'z'; ++c)
+        table[c].kind = ALPHA;
+    for (int c = 'A'; c <= 'Z'; ++c)
+        table[c].kind = ALPHA;
+    for (int c = '0'; c <= '9'; ++c)
+        table[c].kind = DIGIT;
+    for (unsigned char c : {' ', '\t', '\v', '\f', '\r'})
+        table[c] = {SPACE, true};
+    table['\n'] = {NEWLINE, true};
+    table['_'].kind = UNDERSCORE;
+    table['+'] = table['-'] = {SIGN, true};
+    table['"'].kind = table['\''].kind = QUOTE;
+    for (unsigned char c : {'(', ')', '[', ']', '{', '}', ';', ','})
+        table[c].kind = PUNCT;
+    for (unsigned char c : {'*', '/', '%', '^'})
+        table[c] = {PUNCT, true};
+    for (unsigned char c : {'<', '>', '!', '='})
+        table[c] = {RELATION, true};
+    table['&'] = table['|'] = {LOGICAL, true};
+    for (unsigned char c : {';', ')', ']', ','})
+        table[c].endsInteger = true;
+    return table;
+}
+
+inline constexpr std::array<Entry, 256> table = makeTable();
+
+inline const Entry &of(char c) { return table[static_cast<unsigned char>(c)]; }
+
+inline bool isWord(char c) {
+    Class kind = of(c).kind;
+    return kind == ALPHA || kind == DIGIT || kind == UNDERSCORE;
+}
+
+inline int lowestBit(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+#else
+    int bit = 0;
+    for (; !(mask & 1); mask >>= 1)
+        ++bit;
+    return bit;
+#endif
+}
+
+inline int countBits(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(mask);
+#else
+    int count = 0;
+    for (; mask; mask &= mask - 1)
+        ++count;
+    return count;
+#endif
+}
+
+#ifdef CHARSCAN_VECTOR
+// One bit per byte of the block at 'p', set where the byte is in the class
+#if CHARSCAN_VECTOR == 32
+using Vector = __m256i;
+constexpr uint32_t FullMask = 0xFFFFFFFFu;
+inline Vector load(const char *p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+inline Vector splat(char c) { return _mm256_set1_epi8(c); }
+inline Vector equal(Vector a, Vector b) { return _mm256_cmpeq_epi8(a, b); }
+inline Vector greater(Vector a, Vector b) { return _mm256_cmpgt_epi8(a, b); }
+inline Vector either(Vector a, Vector b) { return _mm256_or_si256(a, b); }
+inline Vector both(Vector a, Vector b) { return _mm256_and_si256(a, b); }
+inline uint32_t bits(Vector v) { return _mm256_movemask_epi8(v); }
+#else
+using Vector = __m128i;
+constexpr uint32_t FullMask = 0xFFFFu;
+inline Vector load(const char *p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+inline Vector splat(char c) { return _mm_set1_epi8(c); }
+inline Vector equal(Vector a, Vector b) { return _mm_cmpeq_epi8(a, b); }
+inline Vector greater(Vector a, Vector b) { return _mm_cmpgt_epi8(a, b); }
+inline Vector either(Vector a, Vector b) { return _mm_or_si128(a, b); }
+inline Vector both(Vector a, Vector b) { return _mm_and_si128(a, b); }
+inline uint32_t bits(Vector v) { return _mm_movemask_epi8(v); }
+#endif
+
+// Bytes in [low, high], bytes above 0x7F compare as negative and never match
+inline Vector inRange(Vector v, char low, char high) {
+    return both(greater(v, splat(low - 1)), greater(splat(high + 1), v));
+}
+
+inline uint32_t wordMask(const char *p) {
+    Vector v = load(p);
+    return bits(either(either(inRange(v, 'a', 'z'), inRange(v, 'A', 'Z')),
+                       either(inRange(v, '0', '9'), equal(v, splat('_')))));
+}
+
+inline uint32_t digitMask(const char *p) {
+    return bits(inRange(load(p), '0', '9'));
+}
+
+// '\t' '\n' '\v' '\f' '\r' and ' ', the characters isspace accepts
+inline uint32_t spaceMask(const char *p, uint32_t &newlines) {
+    Vector v = load(p);
+    newlines = bits(equal(v, splat('\n')));
+    return bits(either(inRange(v, '\t', '\r'), equal(v, splat(' '))));
+}
+#endif
+
+// Index of the first character at or after 'pos' that can't continue an
+// identifier
+inline size_t skipWord(const char *text, size_t pos, size_t size) {
+#ifdef CHARSCAN_VECTOR
+    for (; pos + CHARSCAN_VECTOR <= size; pos += CHARSCAN_VECTOR) {
+        uint32_t mask = wordMask(text + pos);
+        if (mask != FullMask)
+            return pos + lowestBit(~mask);
+    }
+#endif
+    while (pos < size && isWord(text[pos]))
+        ++pos;
+    return pos;
+}
+
+inline size_t skipDigits(const char *text, size_t pos, size_t size) {
+#ifdef CHARSCAN_VECTOR
+    for (; pos + CHARSCAN_VECTOR <= size; pos += CHARSCAN_VECTOR) {
+        uint32_t mask = digitMask(text + pos);
+        if (mask != FullMask)
+            return pos + lowestBit(~mask);
+    }
+#endif
+    while (pos < size && of(text[pos]).kind == DIGIT)
+        ++pos;
+    return pos;
+}
+
+// Skips whitespace, adding the newlines passed over to 'line'
+inline size_t skipSpace(const char *text, size_t pos, size_t size,
+                        size_t &line) {
+#ifdef CHARSCAN_VECTOR
+    for (; pos + CHARSCAN_VECTOR <= size; pos += CHARSCAN_VECTOR) {
+        uint32_t newlines;
+        uint32_t mask = spaceMask(text + pos, newlines);
+        if (mask != FullMask) {
+            int run = lowestBit(~mask);
+            line += countBits(newlines & ((uint32_t(1) << run) - 1));
+            return pos + run;
+        }
+        line += countBits(newlines);
+    }
+#endif
+    for (; pos < size; ++pos) {
+        Class kind = of(text[pos]).kind;
+        if (kind == NEWLINE)
+            ++line;
+        else if (kind != SPACE)
+            break;
+    }
+    return pos;
+}
+
+} // namespace CharScan
+
+#endif // CHARSCAN_H
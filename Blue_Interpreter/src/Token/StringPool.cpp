@@ -0,0 +1,29 @@
+#include "StringPool.h"
+
+StringPool _globalStringPool;
+
+StringPool::StringPool() {
+    singleChars.fill(-1);
+    intern("", 0); // id 0 is the empty string
+}
+
+int StringPool::intern(const char *text, size_t length) {
+    if (length == 1) {
+        int &single = singleChars[static_cast<unsigned char>(text[0])];
+        if (single < 0) {
+            single = static_cast<int>(strings.size());
+            strings.emplace_back(text, length);
+            ids.emplace(strings.back(), single);
+        }
+        return single;
+    }
+
+    auto found = ids.find(std::string_view(text, length));
+    if (found != ids.end())
+        return found->second;
+
+    int id = static_cast<int>(strings.size());
+    strings.emplace_back(text, length);
+    ids.emplace(strings.back(), id);
+    return id;
+}
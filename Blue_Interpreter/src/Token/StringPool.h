@@ -0,0 +1,36 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <array>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Interns every distinct identifier and literal of a program. Each string is
+// stored once and referred to by a small integer id, so tokens stay small
+// and two names are equal exactly when their ids are.
+class StringPool {
+  public:
+    StringPool();
+
+    int intern(const char *text, size_t length);
+    int intern(const std::string &text) {
+        return intern(text.data(), text.size());
+    }
+
+    const std::string &get(int id) const { return strings[id]; }
+    size_t size() const { return strings.size(); }
+
+  private:
+    // deque never moves its elements, so the views used as keys stay valid
+    std::deque<std::string> strings;
+    std::unordered_map<std::string_view, int> ids;
+
+    // ids of one character strings, most tokens are punctuation or operators
+    std::array<int, 256> singleChars;
+};
+
+extern StringPool _globalStringPool;
+
+#endif // STRINGPOOL_H
@@ -1,6 +1,8 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include "StringPool.h"
+#include <cstdint>
 #include <iostream>
 #include <string>
 
@@ -51,16 +53,30 @@ class Token {
 
   private:
     Type _type;
-    std::string _value;
-    size_t _lineNum;
+    int _id;              // text of the token in _globalStringPool
+    uint32_t _offset;     // where the token starts in the source
+    uint32_t _length = 0; // span in the source, 0 if it has none
+    uint32_t _lineNum;
 
   public:
     Token(Type type, const std::string &value, size_t lineNum)
-        : _type(type), _value(value), _lineNum(lineNum) {}
+        : _type(type), _id(_globalStringPool.intern(value)), _offset(0),
+          _lineNum(lineNum) {}
+
+    // Unknown token, for buffers filled in later
+    Token() : Token(Type::Unknown, 0, 0, 0, 0) {}
+
+    // Token read from the source, its text was already interned
+    Token(Type type, int id, size_t offset, size_t length, size_t lineNum)
+        : _type(type), _id(id), _offset(offset), _length(length),
+          _lineNum(lineNum) {}
 
     // Accessors functions
     Type type() const { return _type; }
-    std::string value() const { return _value; }
+    const std::string &value() const { return _globalStringPool.get(_id); }
+    int id() const { return _id; }
+    size_t offset() const { return _offset; }
+    size_t length() const { return _length; }
     size_t lineNum() const { return _lineNum; }
 
     // Function to convert Type to a readable string
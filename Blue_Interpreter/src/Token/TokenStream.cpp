@@ -0,0 +1,23 @@
+#include "TokenStream.h"
+#include <stdexcept>
+
+const Token *TokenStream::peek(size_t offset) {
+    if (offset >= Lookahead)
+        throw std::logic_error("Peeking past the token lookahead window");
+
+    size_t position = current + offset;
+    while (read <= position && !exhausted) {
+        if (tokenizer.nextToken(window[read % Lookahead]))
+            read++;
+        else
+            exhausted = true;
+    }
+    return position < read ? &window[position % Lookahead] : nullptr;
+}
+
+void TokenStream::finish() {
+    Token rest;
+    while (!exhausted && tokenizer.nextToken(rest))
+        ;
+    exhausted = true;
+}
@@ -0,0 +1,36 @@
+#ifndef TOKENSTREAM_H
+#define TOKENSTREAM_H
+
+#include "Tokenizer.h"
+#include <array>
+
+// Hands the Parser tokens as it asks for them. The Tokenizer only runs as
+// far as the parser has looked, and just the tokens inside the lookahead
+// window are kept, so memory doesn't grow with the size of the source.
+class TokenStream {
+  public:
+    // The Parser looks at most one token past the current one
+    static constexpr size_t Lookahead = 4;
+
+    explicit TokenStream(Tokenizer &tokenizer) : tokenizer(tokenizer) {}
+
+    // Token 'offset' places after the current one, nullptr past the end
+    const Token *peek(size_t offset = 0);
+
+    // Moves past the current token
+    void advance() { ++current; }
+
+    // Tokenizes the rest of the source so lexical and comment errors further
+    // down are reported first, as they were when the whole file was
+    // tokenized before parsing. Called before a syntax error is reported.
+    void finish();
+
+  private:
+    Tokenizer &tokenizer;
+    std::array<Token, Lookahead> window; // ring buffer indexed by position
+    size_t current = 0;                  // position of the current token
+    size_t read = 0;                     // tokens read from the tokenizer
+    bool exhausted = false;
+};
+
+#endif // TOKENSTREAM_H
@@ -3,12 +3,15 @@
 #include <iostream>
 #include <sstream>
 
-Tokenizer::Tokenizer(const std::vector<char> &file)
-    : _file(file), _size(file.size()) {}
+Tokenizer::Tokenizer(std::string_view source, bool stripComments)
+    : _file(source), _size(source.size()) {
+    if (stripComments)
+        _comments = std::make_unique<CommentFilter>(source);
+}
 
-bool Tokenizer::isOperator(Token t) {
+bool Tokenizer::isOperator(const Token &t) {
 
-    std::string value = t.value();
+    const std::string &value = t.value();
 
     if (value == "+" || value == "-" || value == "*" || value == "/" ||
         value == "%" || value == "^" || value == "=" || value =="<" ||
@@ -30,26 +33,41 @@ bool Tokenizer::isOperator(char value) {
 void Tokenizer::tokenizeVector() {
     _currentPos = 0;
     _currentState = START;
+    Token token;
+    while (nextToken(token))
+        _tokens.push_back(token);
+}
+
+bool Tokenizer::nextToken(Token &token) {
     while (_currentPos < _size) {
-        Token token = getToken(); // Gonna get the next token
-        if (token.type() !=
+        // The DFA reads through the comment filter one character at a time,
+        // a source without comments goes through the table-driven scanner
+        Token next = _comments ? getToken() : scanToken();
+        if (next.type() !=
             Token::Type::Unknown) { // Skipping unknown tokens for now
-            _tokens.push_back(token);
+            _lastToken = token = next;
+            _hasLastToken = true;
+            return true;
         }
     }
+    if (_comments)
+        _comments->finish();
+    return false;
 }
 
 Token Tokenizer::getToken() {
     std::string tokenValue;
     Token::Type tokenType = Token::Type::Unknown;
     size_t tokenLineNum = _lineNum;
+    size_t tokenStart = _currentPos;
     bool tokenFound = false;
 
     while (_currentPos < _size && !tokenFound) {
 
-        char currentChar = _file[_currentPos];
+        char currentChar = charAt(_currentPos);
         switch (_currentState) {
         case START:
+            tokenStart = _currentPos;
             if (currentChar == '\n') {
                 tokenLineNum++;
             } else if (std::isspace(currentChar)) {
@@ -137,7 +155,7 @@ Token Tokenizer::getToken() {
                     break;
                 case '<':
                     if (_currentPos + 1 < _size &&
-                        _file[_currentPos + 1] == '=') {
+                        charAt(_currentPos + 1) == '=') {
                         tokenType = Token::Type::LtEqual;
                         tokenValue = "<=";
                         tokenFound = true;
@@ -150,7 +168,7 @@ Token Tokenizer::getToken() {
                     break;
                 case '>':
                     if (_currentPos + 1 < _size &&
-                        _file[_currentPos + 1] == '=') {
+                        charAt(_currentPos + 1) == '=') {
                         tokenType = Token::Type::GtEqual;
                         tokenValue = ">=";
                         tokenFound = true;
@@ -163,7 +181,7 @@ Token Tokenizer::getToken() {
                     break;
                 case '&':
                     if (_currentPos + 1 < _size &&
-                        _file[_currentPos + 1] == '&') {
+                        charAt(_currentPos + 1) == '&') {
                         tokenType = Token::Type::BooleanAnd;
                         tokenValue = "&&";
                         tokenFound = true;
@@ -173,7 +191,7 @@ Token Tokenizer::getToken() {
 
                 case '|':
                     if (_currentPos + 1 < _size &&
-                        _file[_currentPos + 1] == '|') {
+                        charAt(_currentPos + 1) == '|') {
                         tokenType = Token::Type::BooleanOr;
                         tokenValue = "||";
                         tokenFound = true;
@@ -182,7 +200,7 @@ Token Tokenizer::getToken() {
                     break;
                 case '!':
                     if (_currentPos + 1 < _size &&
-                        _file[_currentPos + 1] == '=') {
+                        charAt(_currentPos + 1) == '=') {
                         tokenType = Token::Type::BooleanNotEqual;
                         tokenValue = "!=";
                         tokenFound = true;
@@ -195,7 +213,7 @@ Token Tokenizer::getToken() {
                     break;
                 case '=':
                     if (_currentPos + 1 < _size &&
-                        _file[_currentPos + 1] == '=') {
+                        charAt(_currentPos + 1) == '=') {
                         tokenType = Token::Type::BooleanEqual;
                         tokenValue = "==";
                         tokenFound = true;
@@ -209,9 +227,9 @@ Token Tokenizer::getToken() {
                 case '+':
                 case '-':
                     // check if last token was an op
-                    if (isOperator(_tokens.back()) ||
-                        _tokens.back().value() == "("
-                        || _tokens.back().value() == "[") {
+                    if (!_hasLastToken || isOperator(_lastToken) ||
+                        _lastToken.value() == "("
+                        || _lastToken.value() == "[") {
                         // Treat as part of an integer if appropriate
                         tokenType = Token::Type::Integer;
                         tokenValue += currentChar;
@@ -261,6 +279,7 @@ Token Tokenizer::getToken() {
             // not a digit
             if ((tokenValue.back() == '+' || tokenValue.back() == '-') &&
                 !isdigit(currentChar)) {
+                reportCommentErrors();
                 std::cerr << "Syntax error on line " << _lineNum
                           << ": invalid signed integer\n";
                 exit(23);
@@ -272,6 +291,7 @@ Token Tokenizer::getToken() {
             } else if (!(isOperator(currentChar) || isspace(currentChar) ||
                          currentChar == ';' || currentChar == ')' || currentChar ==']' || currentChar ==',') ||
                        isalpha(currentChar)) {
+                reportCommentErrors();
                 std::cerr << "Syntax error on line " << _lineNum
                           << ": invalid Integer\n";
                 exit(24);
@@ -284,7 +304,7 @@ Token Tokenizer::getToken() {
         case DQ_STRING:
             if (currentChar == '"') {
                 // if the previous character was a backslash don't count this quote as a quote
-                if (_file[_currentPos - 1] == '\\') {
+                if (charAt(_currentPos - 1) == '\\') {
                     tokenValue += currentChar;
                 }
                 else {
@@ -301,6 +321,7 @@ Token Tokenizer::getToken() {
                 }
             } else {
                 if (currentChar == '\n') {
+                    reportCommentErrors();
                     std::cerr << "Unterminated string quote on line: " << _lineNum << std::endl;
                     exit(25);
                 }
@@ -310,7 +331,7 @@ Token Tokenizer::getToken() {
        
         case SQ_STRING:
             if (currentChar == '\'') {
-                if (_file[_currentPos - 1] == '\\') {
+                if (charAt(_currentPos - 1) == '\\') {
                     tokenValue += currentChar;
                 }
                 else {
@@ -327,6 +348,7 @@ Token Tokenizer::getToken() {
                 }
             } else {
                 if (currentChar == '\n') {
+                    reportCommentErrors();
                     std::cerr << "Unterminated string quote on line: " << _lineNum << std::endl;
                     exit(25);
                 }
@@ -340,11 +362,209 @@ Token Tokenizer::getToken() {
 
     if (tokenFound || !tokenValue.empty()) {
         _lineNum = tokenLineNum;
-        return Token(tokenType, tokenValue, tokenLineNum);
+        // the text of a token is exactly its span of the source, unless a
+        // comment was blanked inside it
+        int id = _comments
+                     ? _globalStringPool.intern(tokenValue)
+                     : _globalStringPool.intern(_file.data() + tokenStart,
+                                                _currentPos - tokenStart);
+        return Token(tokenType, id, tokenStart, _currentPos - tokenStart,
+                     tokenLineNum);
     }
 
     return Token(Token::Type::Unknown, "", -1);
 }
 
+static Token::Type punctuationType(char c) {
+    switch (c) {
+    case '(':
+        return Token::Type::LParen;
+    case ')':
+        return Token::Type::RParen;
+    case '[':
+        return Token::Type::LBracket;
+    case ']':
+        return Token::Type::RBracket;
+    case '{':
+        return Token::Type::LBrace;
+    case '}':
+        return Token::Type::RBrace;
+    case ';':
+        return Token::Type::Semicolon;
+    case ',':
+        return Token::Type::Comma;
+    case '*':
+        return Token::Type::Asterisk;
+    case '/':
+        return Token::Type::Slash;
+    case '%':
+        return Token::Type::Modulo;
+    default:
+        return Token::Type::Caret;
+    }
+}
+
+// Token types isOperator accepts, and the opening brackets. A sign after
+// one of them belongs to an integer.
+static bool beforeOperand(Token::Type type) {
+    switch (type) {
+    case Token::Type::Plus:
+    case Token::Type::Minus:
+    case Token::Type::Asterisk:
+    case Token::Type::Slash:
+    case Token::Type::Modulo:
+    case Token::Type::Caret:
+    case Token::Type::AssignmentOperator:
+    case Token::Type::Lt:
+    case Token::Type::LtEqual:
+    case Token::Type::Gt:
+    case Token::Type::GtEqual:
+    case Token::Type::BooleanNot:
+    case Token::Type::BooleanAnd:
+    case Token::Type::BooleanOr:
+    case Token::Type::BooleanEqual:
+    case Token::Type::BooleanNotEqual:
+    case Token::Type::LParen:
+    case Token::Type::LBracket:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static Token::Type relationType(char c, bool withEqual) {
+    switch (c) {
+    case '<':
+        return withEqual ? Token::Type::LtEqual : Token::Type::Lt;
+    case '>':
+        return withEqual ? Token::Type::GtEqual : Token::Type::Gt;
+    case '!':
+        return withEqual ? Token::Type::BooleanNotEqual
+                         : Token::Type::BooleanNot;
+    default:
+        return withEqual ? Token::Type::BooleanEqual
+                         : Token::Type::AssignmentOperator;
+    }
+}
+
+// Same tokens, line numbers and errors as getToken, but each character is
+// classified with a single table lookup and runs of identifier, digit and
+// whitespace characters are skipped by CharScan a vector at a time. Tokens
+// are spans of the source, no token text is built up.
+Token Tokenizer::scanToken() {
+    using namespace CharScan;
+    const char *text = _file.data();
+    size_t line = _lineNum; // errors report _lineNum, like getToken
+
+    for (;;) {
+        _currentPos = skipSpace(text, _currentPos, _size, line);
+        if (_currentPos >= _size)
+            return Token(Token::Type::Unknown, "", -1);
+
+        size_t start = _currentPos;
+        char c = text[_currentPos++];
+        char next = _currentPos < _size ? text[_currentPos] : '\0';
+
+        switch (of(c).kind) {
+        case ALPHA: {
+            _currentPos = skipWord(text, _currentPos, _size);
+            // getToken only checks for TRUE and FALSE once the word is
+            // followed by something
+            std::string_view word(text + start, _currentPos - start);
+            Token::Type type = Token::Type::Identifier;
+            if (_currentPos < _size && word == "TRUE")
+                type = Token::Type::BooleanTrue;
+            else if (_currentPos < _size && word == "FALSE")
+                type = Token::Type::BooleanFalse;
+            return spanToken(type, start, line);
+        }
+
+        case SIGN:
+            // a sign after an operator or an opening bracket starts an
+            // integer
+            if (_hasLastToken && !beforeOperand(_lastToken.type())) {
+                return spanToken(c == '+' ? Token::Type::Plus
+                                          : Token::Type::Minus,
+                                 start, line);
+            }
+            if (_currentPos < _size && of(next).kind != DIGIT) {
+                std::cerr << "Syntax error on line " << _lineNum
+                          << ": invalid signed integer\n";
+                exit(23);
+            }
+            [[fallthrough]];
+
+        case DIGIT:
+            _currentPos = skipDigits(text, _currentPos, _size);
+            if (_currentPos < _size && !of(text[_currentPos]).endsInteger) {
+                std::cerr << "Syntax error on line " << _lineNum
+                          << ": invalid Integer\n";
+                exit(24);
+            }
+            return spanToken(Token::Type::Integer, start, line);
+
+        case QUOTE:
+            for (; _currentPos < _size; ++_currentPos) {
+                char current = text[_currentPos];
+                if (current == c && text[_currentPos - 1] != '\\') {
+                    bool empty = _currentPos == start + 1;
+                    ++_currentPos;
+                    if (c == '"')
+                        return spanToken(empty ? Token::Type::DoubleQuote
+                                               : Token::Type::DoubleQuotedString,
+                                         start, line);
+                    return spanToken(empty ? Token::Type::SingleQuote
+                                           : Token::Type::SingleQuotedString,
+                                     start, line);
+                }
+                if (current == '\n') {
+                    std::cerr << "Unterminated string quote on line: "
+                              << _lineNum << std::endl;
+                    exit(25);
+                }
+            }
+            break; // unterminated at the end of the source, dropped
+
+        case PUNCT:
+            return spanToken(punctuationType(c), start, line);
+
+        case RELATION:
+            if (next == '=')
+                ++_currentPos;
+            return spanToken(relationType(c, next == '='), start, line);
+
+        case LOGICAL:
+            if (next == c) {
+                ++_currentPos;
+                return spanToken(c == '&' ? Token::Type::BooleanAnd
+                                          : Token::Type::BooleanOr,
+                                 start, line);
+            }
+            continue; // a single '&' or '|' is skipped
+
+        default:
+            break;
+        }
+
+        // not part of any token, dropped by tokenizeVector
+        _lineNum = line;
+        return Token(Token::Type::Unknown, "", -1);
+    }
+}
+
+Token Tokenizer::spanToken(Token::Type type, size_t start, size_t lineNum) {
+    _lineNum = lineNum;
+    size_t length = _currentPos - start;
+    int id = _globalStringPool.intern(_file.data() + start, length);
+    return Token(type, id, start, length, lineNum);
+}
+
+// A separate comment pass reports its errors before any token is read, so
+// the fused lexer checks the rest of the source before a syntax error
+void Tokenizer::reportCommentErrors() {
+    if (_comments)
+        _comments->finish();
+}
+
 // Method to return the tokens vector
-std::vector<Token> Tokenizer::getTokens() const { return _tokens; }
+const std::vector<Token> &Tokenizer::getTokens() const { return _tokens; }
@@ -1,8 +1,12 @@
 #ifndef TOKENIZER_H
 #define TOKENIZER_H
 
+#include "../CommentRemoval/CommentFilter.h"
+#include "CharScan.h"
 #include "Token.h"
 #include <cctype> // For isspace, isalpha, etc..
+#include <memory>
+#include <string_view>
 #include <vector>
 
 class Tokenizer {
@@ -15,23 +19,44 @@ class Tokenizer {
         SQ_STRING,
     };
 
-    explicit Tokenizer(const std::vector<char> &file); // Pass by const ref
+    // Reads 'source' in place, it must outlive the tokenizer. With
+    // 'stripComments' the source still has its comments, they are removed
+    // in the same pass as tokenizing.
+    explicit Tokenizer(std::string_view source, bool stripComments = false);
 
-    bool isOperator(Token t);
+    bool isOperator(const Token &t);
     bool isOperator(char t);
 
     void tokenizeVector();
-    std::vector<Token> getTokens() const;
+    const std::vector<Token> &getTokens() const;
+
+    // Reads the next token into 'token', false once the source is used up.
+    // Used by TokenStream to tokenize only as far as the parser has read.
+    bool nextToken(Token &token);
+
+    // With comments stripped here, runs the comment filter over the rest of
+    // the source and throws on a comment error, as the separate pass would
+    // have before any token was read
+    void reportCommentErrors();
 
   private:
-    std::vector<char> _file;
+    std::string_view _file;
+    std::unique_ptr<CommentFilter> _comments; // set when stripping comments
     std::vector<Token> _tokens;
+    Token _lastToken; // decides whether a sign starts an integer
+    bool _hasLastToken = false;
     size_t _currentPos = 0; // index as we tokenize
     size_t _size;           // To store the size of vector passed in
     size_t _lineNum = 1;    // for error output
     State _currentState = START;
 
     Token getToken();
+    Token scanToken();
+    Token spanToken(Token::Type type, size_t start, size_t lineNum);
+
+    char charAt(size_t index) {
+        return _comments ? _comments->at(index) : _file[index];
+    }
 };
 
 #endif // TOKENIZER_H
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "RegisterMachine.h"
+#include "../ErrorHandler/ErrorHandler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+RegisterMachine::RegisterMachine(const RegisterProgram &program,
+                                 OutputSink &output,
+                                 const ExecutionLimits &limits)
+    : program(program), output(output), limits(limits),
+      globals(program.numGlobals, 0), locals(program.entryFrameSize, 0) {
+    // constants are never written, the const_cast only shares one table
+    bases[static_cast<int>(OperandKind::Constant)] =
+        const_cast<int *>(program.constants.data());
+    bases[static_cast<int>(OperandKind::Global)] = globals.data();
+    bases[static_cast<int>(OperandKind::Frame)] = locals.data();
+}
+
+// The comparison of a BRANCH
+static inline bool compare(OpCode cond, int left, int right) {
+    switch (cond) {
+    case OpCode::EQ:
+        return left == right;
+    case OpCode::NE:
+        return left != right;
+    case OpCode::LT:
+        return left < right;
+    case OpCode::GT:
+        return left > right;
+    case OpCode::LE:
+        return left <= right;
+    default:
+        return left >= right;
+    }
+}
+
+// The same two ways to dispatch as VirtualMachine::run
+#ifdef VM_THREADED_DISPATCH
+#define CASE(op) op_##op
+#define DISPATCH()                                                             \
+    do {                                                                       \
+        FETCH();                                                               \
+        goto *handlers[static_cast<int>(ins->op)];                             \
+    } while (0)
+#else
+#define CASE(op) case RegOp::op
+#define DISPATCH() goto dispatch
+#endif
+
+#define FETCH()                                                                \
+    do {                                                                       \
+        ins = &code[pc];                                                       \
+        if (opCounts)                                                          \
+            opCounts[static_cast<int>(ins->op)]++;                             \
+        if (limits.due())                                                      \
+            limits.check(memoryInUse(), program.lines[pc]);                    \
+    } while (0)
+#define NEXT()                                                                 \
+    do {                                                                       \
+        pc++;                                                                  \
+        DISPATCH();                                                            \
+    } while (0)
+#define BINARY(op, expression)                                                 \
+    CASE(op) : {                                                               \
+        int left = at(ins->a);                                                 \
+        int right = at(ins->b);                                                \
+        at(ins->dst) = (expression);                                           \
+        NEXT();                                                                \
+    }
+
+void RegisterMachine::run() {
+    const RegInstruction *code = program.code.data();
+    const RegInstruction *ins;
+    int pc = 0;
+    int base = 0; // start of the current frame in 'locals'
+    int *&frame = bases[static_cast<int>(OperandKind::Frame)];
+
+    vector<uint64_t> counted(_globalOpCounts ? RegOpCount : 0, 0);
+    uint64_t *opCounts = _globalOpCounts ? counted.data() : nullptr;
+
+#ifdef VM_THREADED_DISPATCH
+    // in the order of RegOp
+    static const void *const handlers[] = {
+        &&op_MOVE,
+        &&op_ADD,
+        &&op_SUB,
+        &&op_MUL,
+        &&op_DIV,
+        &&op_MOD,
+        &&op_POW,
+        &&op_AND,
+        &&op_OR,
+        &&op_EQ,
+        &&op_NE,
+        &&op_LT,
+        &&op_GT,
+        &&op_LE,
+        &&op_GE,
+        &&op_NOT,
+        &&op_LOAD_ELEM,
+        &&op_STORE_ELEM,
+        &&op_JUMP,
+        &&op_JUMP_IF_FALSE,
+        &&op_BRANCH,
+        &&op_CALL,
+        &&op_RETURN,
+        &&op_PRINT_INT,
+        &&op_PRINT_TEXT,
+        &&op_PRINT_STR,
+        &&op_EXIT,
+        &&op_HALT,
+    };
+    static_assert(sizeof(handlers) / sizeof(handlers[0]) == RegOpCount,
+                  "every RegOp needs a handler");
+
+    DISPATCH();
+    {
+#else
+dispatch:
+    FETCH();
+    switch (ins->op) {
+#endif
+    CASE(MOVE):
+        at(ins->dst) = at(ins->a);
+        NEXT();
+    BINARY(ADD, left + right)
+    BINARY(SUB, left - right)
+    BINARY(MUL, left * right)
+    BINARY(DIV, left / right)
+    BINARY(MOD, left % right)
+    BINARY(POW, static_cast<int>(pow(left, right)))
+    BINARY(AND, left && right)
+    BINARY(OR, left || right)
+    BINARY(EQ, left == right)
+    BINARY(NE, left != right)
+    BINARY(LT, left < right)
+    BINARY(GT, left > right)
+    BINARY(LE, left <= right)
+    BINARY(GE, left >= right)
+    CASE(NOT):
+        at(ins->dst) = !at(ins->a);
+        NEXT();
+    CASE(LOAD_ELEM): {
+        int index = at(ins->b);
+        checkIndex(index, ins->extra, pc);
+        at(ins->dst) = (&at(ins->a))[index];
+        NEXT();
+    }
+    CASE(STORE_ELEM): {
+        int index = at(ins->a);
+        checkIndex(index, ins->extra, pc);
+        (&at(ins->dst))[index] = at(ins->b);
+        NEXT();
+    }
+    CASE(JUMP):
+        pc = ins->extra;
+        DISPATCH();
+    CASE(JUMP_IF_FALSE):
+        if (at(ins->a) == 0) {
+            pc = ins->extra;
+            DISPATCH();
+        }
+        NEXT();
+    CASE(BRANCH):
+        if (!compare(ins->cond, at(ins->a), at(ins->b))) {
+            pc = ins->extra;
+            DISPATCH();
+        }
+        NEXT();
+    CASE(CALL): {
+        const FunctionInfo &function = program.functions[ins->extra];
+        int newBase = static_cast<int>(locals.size());
+        locals.resize(newBase + function.frameSize, 0);
+
+        // the arguments are in consecutive registers of the caller
+        int first = base + operandIndex(ins->a);
+        for (size_t i = 0; i < function.paramOffsets.size(); ++i)
+            locals[newBase + function.paramOffsets[i]] = locals[first + i];
+
+        callStack.push_back({pc + 1, base, ins->dst});
+        limits.checkCall(callStack.size(), program.lines[pc]);
+        base = newBase;
+        frame = locals.data() + base;
+        pc = function.entry;
+        DISPATCH();
+    }
+    CASE(RETURN): {
+        int value = at(ins->a);
+        Frame caller = callStack.back();
+        callStack.pop_back();
+        locals.resize(base);
+        base = caller.base;
+        frame = locals.data() + base;
+        at(caller.result) = value;
+        pc = caller.returnPC;
+        DISPATCH();
+    }
+    CASE(PRINT_INT):
+        output.writeInt(at(ins->a));
+        NEXT();
+    CASE(PRINT_TEXT):
+        output.write(program.strings[ins->extra]);
+        NEXT();
+    CASE(PRINT_STR):
+        output.writeCharArray(&at(ins->a), ins->extra);
+        NEXT();
+    CASE(EXIT):
+        if (opCounts) {
+            output.flush();
+            printOpCounts(opCounts);
+        }
+        exit(ins->extra);
+    CASE(HALT):
+        output.flush();
+        if (opCounts)
+            printOpCounts(opCounts);
+        return;
+    }
+}
+
+#undef CASE
+#undef DISPATCH
+#undef FETCH
+#undef NEXT
+#undef BINARY
+
+// How often each instruction ran, most frequent first
+void RegisterMachine::printOpCounts(const uint64_t *counts) const {
+    vector<int> ops;
+    for (int op = 0; op < RegOpCount; ++op)
+        if (counts[op] > 0)
+            ops.push_back(op);
+    stable_sort(ops.begin(), ops.end(), [counts](int left, int right) {
+        return counts[left] > counts[right];
+    });
+
+    uint64_t total = 0;
+    for (int op : ops)
+        total += counts[op];
+
+    cerr << "Instructions executed: " << total << endl;
+    for (int op : ops)
+        cerr << "    " << setw(22) << left
+             << RegisterProgram::opToString(static_cast<RegOp>(op)) << right
+             << setw(14) << counts[op] << endl;
+}
+
+// Bytes of program values, what the memory limit is compared against
+size_t RegisterMachine::memoryInUse() const {
+    return (globals.size() + locals.size()) * sizeof(int) +
+           callStack.size() * sizeof(Frame);
+}
+
+void RegisterMachine::checkIndex(int index, int size, int pc) {
+    if (index < 0 || index >= size) {
+        _globalErrorHandler.handle(39, program.lines[pc], to_string(index));
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef REGISTERMACHINE_H
+#define REGISTERMACHINE_H
+
+#include "../Bytecode/RegisterProgram.h"
+#include "../Limits/ExecutionLimits.h"
+#include "../Output/OutputSink.h"
+#include "VirtualMachine.h"
+#include <cstdint>
+#include <vector>
+
+// Virtual machine executing a RegisterProgram, the register form of a
+// compiled program selected with run-reg
+class RegisterMachine {
+  public:
+    explicit RegisterMachine(const RegisterProgram &program,
+                             OutputSink &output = _globalOutput,
+                             const ExecutionLimits &limits = _globalLimits);
+
+    void run();
+
+  private:
+    // Saved state of the caller while a function executes
+    struct Frame {
+        int returnPC;
+        int base;
+        Operand result; // where the caller wants the return value
+    };
+
+    const RegisterProgram &program;
+    OutputSink &output; // where the PRINT instructions write
+    LimitGuard limits;  // checked before every instruction
+
+    std::vector<int> globals;
+    std::vector<int> locals; // frames of all active calls, back to back
+    std::vector<Frame> callStack;
+
+    // Start of the constants, the globals and the current frame, indexed
+    // by OperandKind
+    int *bases[3];
+
+    int &at(Operand operand) { return bases[operand & 3][operand >> 2]; }
+
+    size_t memoryInUse() const;
+    void printOpCounts(const uint64_t *counts) const;
+    void checkIndex(int index, int size, int pc);
+};
+
+#endif // REGISTERMACHINE_H
@@ -0,0 +1,407 @@
+#include "VirtualMachine.h"
+#include "../ErrorHandler/ErrorHandler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+bool _globalOpCounts = false;
+
+VirtualMachine::VirtualMachine(const BytecodeProgram &program,
+                               OutputSink &output,
+                               const ExecutionLimits &limits)
+    : program(program), output(output), limits(limits),
+      globals(program.numGlobals, 0) {
+    stack.reserve(256);
+}
+
+// The comparison of a BRANCH superinstruction
+static inline bool compare(OpCode cond, int left, int right) {
+    switch (cond) {
+    case OpCode::EQ:
+        return left == right;
+    case OpCode::NE:
+        return left != right;
+    case OpCode::LT:
+        return left < right;
+    case OpCode::GT:
+        return left > right;
+    case OpCode::LE:
+        return left <= right;
+    default:
+        return left >= right;
+    }
+}
+
+inline int VirtualMachine::pop() {
+    int value = stack.back();
+    stack.pop_back();
+    return value;
+}
+
+// With VM_THREADED_DISPATCH every handler ends by jumping straight to the
+// handler of the next instruction through a table of label addresses, a
+// GCC and Clang extension, so each handler has an indirect branch of its own
+// for the predictor to learn. Otherwise the same handlers are the cases of
+// one switch. CMakeLists.txt picks the first when the compiler supports it.
+#ifdef VM_THREADED_DISPATCH
+#define CASE(op) op_##op
+#define DISPATCH()                                                             \
+    do {                                                                       \
+        FETCH();                                                               \
+        goto *handlers[static_cast<int>(ins->op)];                             \
+    } while (0)
+#else
+#define CASE(op) case OpCode::op
+#define DISPATCH() goto dispatch
+#endif
+
+// Every instruction is counted for --op-counts and passes the limit check
+// before it runs
+#define FETCH()                                                                \
+    do {                                                                       \
+        ins = &code[pc];                                                       \
+        if (opCounts)                                                          \
+            opCounts[static_cast<int>(ins->op)]++;                             \
+        if (limits.due())                                                      \
+            limits.check(memoryInUse(), program.lines[pc]);                    \
+    } while (0)
+#define NEXT()                                                                 \
+    do {                                                                       \
+        pc++;                                                                  \
+        DISPATCH();                                                            \
+    } while (0)
+
+void VirtualMachine::run() {
+    const Instruction *code = program.code.data();
+    const Instruction *ins;
+    int pc = 0;
+    int base = 0; // start of the current frame in 'locals'
+
+    vector<uint64_t> counted(_globalOpCounts ? OpCodeCount : 0, 0);
+    uint64_t *opCounts = _globalOpCounts ? counted.data() : nullptr;
+
+#ifdef VM_THREADED_DISPATCH
+    // in the order of OpCode
+    static const void *const handlers[] = {
+        &&op_PUSH,
+        &&op_POP,
+        &&op_LOAD_GLOBAL,
+        &&op_STORE_GLOBAL,
+        &&op_LOAD_LOCAL,
+        &&op_STORE_LOCAL,
+        &&op_LOAD_GLOBAL_ELEM,
+        &&op_STORE_GLOBAL_ELEM,
+        &&op_LOAD_LOCAL_ELEM,
+        &&op_STORE_LOCAL_ELEM,
+        &&op_ADD,
+        &&op_SUB,
+        &&op_MUL,
+        &&op_DIV,
+        &&op_MOD,
+        &&op_POW,
+        &&op_AND,
+        &&op_OR,
+        &&op_EQ,
+        &&op_NE,
+        &&op_LT,
+        &&op_GT,
+        &&op_LE,
+        &&op_GE,
+        &&op_NOT,
+        &&op_JUMP,
+        &&op_JUMP_IF_FALSE,
+        &&op_CALL,
+        &&op_RETURN,
+        &&op_PRINT_INT,
+        &&op_PRINT_TEXT,
+        &&op_PRINT_STR_GLOBAL,
+        &&op_PRINT_STR_LOCAL,
+        &&op_EXIT,
+        &&op_HALT,
+        &&op_INC_GLOBAL,
+        &&op_INC_LOCAL,
+        &&op_BRANCH_GLOBAL,
+        &&op_BRANCH_LOCAL,
+        &&op_MOD_BRANCH_GLOBAL,
+        &&op_MOD_BRANCH_LOCAL,
+        &&op_STORE_GLOBAL_ELEM_AT,
+        &&op_STORE_LOCAL_ELEM_AT,
+    };
+    static_assert(sizeof(handlers) / sizeof(handlers[0]) == OpCodeCount,
+                  "every OpCode needs a handler");
+
+    DISPATCH();
+    {
+#else
+dispatch:
+    FETCH();
+    switch (ins->op) {
+#endif
+    CASE(PUSH):
+        stack.push_back(ins->a);
+        NEXT();
+    CASE(POP):
+        stack.pop_back();
+        NEXT();
+    CASE(LOAD_GLOBAL):
+        stack.push_back(globals[ins->a]);
+        NEXT();
+    CASE(STORE_GLOBAL):
+        globals[ins->a] = pop();
+        NEXT();
+    CASE(LOAD_LOCAL):
+        stack.push_back(locals[base + ins->a]);
+        NEXT();
+    CASE(STORE_LOCAL):
+        locals[base + ins->a] = pop();
+        NEXT();
+    CASE(LOAD_GLOBAL_ELEM): {
+        int index = pop();
+        checkIndex(index, ins->b, pc);
+        stack.push_back(globals[ins->a + index]);
+        NEXT();
+    }
+    CASE(STORE_GLOBAL_ELEM): {
+        int value = pop();
+        int index = pop();
+        checkIndex(index, ins->b, pc);
+        globals[ins->a + index] = value;
+        NEXT();
+    }
+    CASE(LOAD_LOCAL_ELEM): {
+        int index = pop();
+        checkIndex(index, ins->b, pc);
+        stack.push_back(locals[base + ins->a + index]);
+        NEXT();
+    }
+    CASE(STORE_LOCAL_ELEM): {
+        int value = pop();
+        int index = pop();
+        checkIndex(index, ins->b, pc);
+        locals[base + ins->a + index] = value;
+        NEXT();
+    }
+    CASE(ADD): {
+        int right = pop();
+        stack.back() += right;
+        NEXT();
+    }
+    CASE(SUB): {
+        int right = pop();
+        stack.back() -= right;
+        NEXT();
+    }
+    CASE(MUL): {
+        int right = pop();
+        stack.back() *= right;
+        NEXT();
+    }
+    CASE(DIV): {
+        int right = pop();
+        stack.back() /= right;
+        NEXT();
+    }
+    CASE(MOD): {
+        int right = pop();
+        stack.back() %= right;
+        NEXT();
+    }
+    CASE(POW): {
+        int right = pop();
+        stack.back() = static_cast<int>(pow(stack.back(), right));
+        NEXT();
+    }
+    CASE(AND): {
+        int right = pop();
+        stack.back() = stack.back() && right;
+        NEXT();
+    }
+    CASE(OR): {
+        int right = pop();
+        stack.back() = stack.back() || right;
+        NEXT();
+    }
+    CASE(EQ): {
+        int right = pop();
+        stack.back() = stack.back() == right;
+        NEXT();
+    }
+    CASE(NE): {
+        int right = pop();
+        stack.back() = stack.back() != right;
+        NEXT();
+    }
+    CASE(LT): {
+        int right = pop();
+        stack.back() = stack.back() < right;
+        NEXT();
+    }
+    CASE(GT): {
+        int right = pop();
+        stack.back() = stack.back() > right;
+        NEXT();
+    }
+    CASE(LE): {
+        int right = pop();
+        stack.back() = stack.back() <= right;
+        NEXT();
+    }
+    CASE(GE): {
+        int right = pop();
+        stack.back() = stack.back() >= right;
+        NEXT();
+    }
+    CASE(NOT):
+        stack.back() = !stack.back();
+        NEXT();
+    CASE(JUMP):
+        pc = ins->a;
+        DISPATCH();
+    CASE(JUMP_IF_FALSE):
+        if (pop() == 0) {
+            pc = ins->a;
+            DISPATCH();
+        }
+        NEXT();
+    CASE(CALL): {
+        const FunctionInfo &function = program.functions[ins->a];
+        int newBase = static_cast<int>(locals.size());
+        locals.resize(newBase + function.frameSize, 0);
+
+        // arguments were pushed in order, so the last one is on top
+        for (int i = static_cast<int>(function.paramOffsets.size()) - 1;
+             i >= 0; --i)
+            locals[newBase + function.paramOffsets[i]] = pop();
+
+        callStack.push_back({pc + 1, base});
+        limits.checkCall(callStack.size(), program.lines[pc]);
+        base = newBase;
+        pc = function.entry;
+        DISPATCH();
+    }
+    CASE(RETURN): {
+        Frame caller = callStack.back();
+        callStack.pop_back();
+        locals.resize(base);
+        base = caller.base;
+        pc = caller.returnPC;
+        DISPATCH(); // the return value stays on top of the stack
+    }
+    CASE(PRINT_INT):
+        output.writeInt(pop());
+        NEXT();
+    CASE(PRINT_TEXT):
+        output.write(program.strings[ins->a]);
+        NEXT();
+    CASE(PRINT_STR_GLOBAL):
+        output.writeCharArray(&globals[ins->a], ins->b);
+        NEXT();
+    CASE(PRINT_STR_LOCAL):
+        output.writeCharArray(&locals[base + ins->a], ins->b);
+        NEXT();
+    CASE(EXIT):
+        if (opCounts) {
+            output.flush();
+            printOpCounts(opCounts);
+        }
+        exit(ins->a);
+    CASE(HALT):
+        output.flush();
+        if (opCounts)
+            printOpCounts(opCounts);
+        return;
+    CASE(INC_GLOBAL):
+        globals[ins->a] += ins->b;
+        NEXT();
+    CASE(INC_LOCAL):
+        locals[base + ins->a] += ins->b;
+        NEXT();
+    CASE(BRANCH_GLOBAL):
+        if (!compare(ins->cond, globals[ins->a], ins->b)) {
+            pc = ins->c;
+            DISPATCH();
+        }
+        NEXT();
+    CASE(BRANCH_LOCAL):
+        if (!compare(ins->cond, locals[base + ins->a], ins->b)) {
+            pc = ins->c;
+            DISPATCH();
+        }
+        NEXT();
+    CASE(MOD_BRANCH_GLOBAL):
+        if (!compare(ins->cond, globals[ins->a] % ins->b, 0)) {
+            pc = ins->c;
+            DISPATCH();
+        }
+        NEXT();
+    CASE(MOD_BRANCH_LOCAL):
+        if (!compare(ins->cond, locals[base + ins->a] % ins->b, 0)) {
+            pc = ins->c;
+            DISPATCH();
+        }
+        NEXT();
+    CASE(STORE_GLOBAL_ELEM_AT): {
+        int value = pop();
+        int index = locals[base + ins->c];
+        checkIndex(index, ins->b, pc);
+        globals[ins->a + index] = value;
+        NEXT();
+    }
+    CASE(STORE_LOCAL_ELEM_AT): {
+        int value = pop();
+        int index = locals[base + ins->c];
+        checkIndex(index, ins->b, pc);
+        locals[base + ins->a + index] = value;
+        NEXT();
+    }
+    }
+}
+
+#undef CASE
+#undef DISPATCH
+#undef FETCH
+#undef NEXT
+
+// How often each instruction ran, most frequent first, superinstructions
+// listed before the rest
+void VirtualMachine::printOpCounts(const uint64_t *counts) const {
+    vector<int> ops;
+    for (int op = 0; op < OpCodeCount; ++op)
+        if (counts[op] > 0)
+            ops.push_back(op);
+    stable_sort(ops.begin(), ops.end(), [counts](int left, int right) {
+        bool leftFused = isSuperinstruction(static_cast<OpCode>(left));
+        bool rightFused = isSuperinstruction(static_cast<OpCode>(right));
+        if (leftFused != rightFused)
+            return leftFused;
+        return counts[left] > counts[right];
+    });
+
+    uint64_t total = 0;
+    for (int op : ops)
+        total += counts[op];
+
+    cerr << "Instructions executed: " << total << endl;
+    for (int op : ops) {
+        OpCode code = static_cast<OpCode>(op);
+        cerr << (isSuperinstruction(code) ? "  * " : "    ") << setw(22) << left
+             << BytecodeProgram::opCodeToString(code) << right << setw(14)
+             << counts[op] << endl;
+    }
+}
+
+// Bytes of program values, what the memory limit is compared against
+size_t VirtualMachine::memoryInUse() const {
+    return (globals.size() + locals.size() + stack.size()) * sizeof(int) +
+           callStack.size() * sizeof(Frame);
+}
+
+void VirtualMachine::checkIndex(int index, int size, int pc) {
+    if (index < 0 || index >= size) {
+        _globalErrorHandler.handle(39, program.lines[pc], to_string(index));
+    }
+}
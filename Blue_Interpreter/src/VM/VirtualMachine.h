@@ -0,0 +1,45 @@
+#ifndef VIRTUALMACHINE_H
+#define VIRTUALMACHINE_H
+
+#include "../Bytecode/Bytecode.h"
+#include "../Limits/ExecutionLimits.h"
+#include "../Output/OutputSink.h"
+#include <cstdint>
+#include <vector>
+
+// Print how often each instruction ran to stderr when a program ends, set by
+// --op-counts
+extern bool _globalOpCounts;
+
+// Stack based virtual machine executing a compiled BytecodeProgram
+class VirtualMachine {
+  public:
+    explicit VirtualMachine(const BytecodeProgram &program,
+                            OutputSink &output = _globalOutput,
+                            const ExecutionLimits &limits = _globalLimits);
+
+    void run();
+
+  private:
+    // Saved state of the caller while a function executes
+    struct Frame {
+        int returnPC;
+        int base;
+    };
+
+    const BytecodeProgram &program;
+    OutputSink &output; // where the PRINT instructions write
+    LimitGuard limits;  // checked before every instruction
+
+    std::vector<int> globals;
+    std::vector<int> locals; // frames of all active calls, back to back
+    std::vector<int> stack;  // operand stack
+    std::vector<Frame> callStack;
+
+    int pop();
+    size_t memoryInUse() const;
+    void printOpCounts(const uint64_t *counts) const;
+    void checkIndex(int index, int size, int pc);
+};
+
+#endif // VIRTUALMACHINE_H
@@ -6,95 +6,134 @@
  *
  */
 
-#include "./Interpreter/Interpreter.h"
-#include "./AST/ASTParser.h"
-#include "./CST/Parser.h"
 #include "./CommentRemoval/fileAsArray.h"
-#include "./OutputGenerator/OutPutGenerator.h"
-#include "./SymbolTable/SymbolTablesLinkedList.h"
-#include "./Token/Tokenizer.h"
-
-#include "./Node/Node.h"
-#include "./Token/Token.h"
-
+#include "./Driver/Driver.h"
+#include "./ErrorHandler/ErrorHandler.h"
+#include "./Limits/ExecutionLimits.h"
+#include "./Optimizer/ASTOptimizer.h"
+#include "./Server/Server.h"
+#include "./VM/VirtualMachine.h"
+
+#include <cctype>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <string>
 
 using namespace std;
 
-int main(int argc, char *argv[])
+// Reads the number of a "<name><number>" flag, false if it isn't one
+static bool numberFlag(const string &flag, const string &name, uint64_t &value)
 {
-    if (argc < 3)
-    {
-        cerr << "Usage: " << argv[0] << " <filename> <option>" << endl;
-        return 1;
-    }
-
-    string filename = argv[1];
-    string option = argv[2];
+    size_t digits = flag.size() - name.size();
+    if (flag.rfind(name, 0) != 0 || digits == 0 || digits > 18)
+        return false;
+    for (size_t i = name.size(); i < flag.size(); ++i)
+        if (!isdigit(static_cast<unsigned char>(flag[i])))
+            return false;
+    value = stoull(flag.substr(name.size()));
+    return true;
+}
 
-    fileAsArray fileArray(filename);
-    fileArray.readFile();
+int main(int argc, char *argv[])
+{
+    // --serve answers requests on stdin, --serve=<path> on a Unix socket
+    string first = argc > 1 ? argv[1] : "";
+    bool serve = first == "--serve" || first.rfind("--serve=", 0) == 0;
 
-    try
-    {
-        fileArray.File_w_no_comments();
-    }
-    catch (const std::exception &error)
+    if (argc < 3 && !serve)
     {
-        cerr << "Exception caught: " << error.what() << endl;
+        cerr << "Usage: " << argv[0] << " <filename> <option> [flags]" << endl;
+        cerr << "       " << argv[0] << " --serve[=<socket path>] [flags]"
+             << endl;
         return 1;
     }
 
-    Tokenizer tokenizer(fileArray.getFileContent());
-    tokenizer.tokenizeVector();
-    vector<Token> tokens = tokenizer.getTokens();
-
-    if (option == "tokens")
+    // --fused-lexer: strip comments while tokenizing instead of in a pass
+    // of its own
+    // --cache-dir=<path>: keep compiled programs there and run them from it
+    // when the same source comes again
+    // --image=<path>, --bytecode: where compile writes the image, and whether
+    // it holds bytecode instead of the AST
+    // --max-steps=<n>, --max-memory=<MiB>, --time-limit=<ms>: stop a program
+    // that runs longer or stores more than that with error 40
+    // --op-counts: after run-vm or run-reg, print how often each instruction
+    // ran
+    // -O<level>: optimize the AST, -O alone is -O1, see ASTOptimizer.h
+    bool fusedLexer = false;
+    bool bytecodeImage = false;
+    string cacheDirectory;
+    string imagePath;
+    for (int i = serve ? 2 : 3; i < argc; ++i)
     {
-        for (const auto &token : tokens)
+        string flag = argv[i];
+        uint64_t limit;
+        if (flag == "--fused-lexer")
+            fusedLexer = true;
+        else if (flag.rfind("--cache-dir=", 0) == 0 && flag.size() > 12)
+            cacheDirectory = flag.substr(12);
+        else if (flag.rfind("--image=", 0) == 0 && flag.size() > 8)
+            imagePath = flag.substr(8);
+        else if (flag == "--bytecode")
+            bytecodeImage = true;
+        else if (flag == "--op-counts")
+            _globalOpCounts = true;
+        else if (numberFlag(flag, "--max-steps=", limit))
+            _globalLimits.maxSteps = limit;
+        else if (numberFlag(flag, "--max-memory=", limit))
+            _globalLimits.maxMemory = limit * 1024 * 1024;
+        else if (numberFlag(flag, "--time-limit=", limit))
+            _globalLimits.maxMilliseconds = static_cast<unsigned>(limit);
+        else if (flag == "-O")
+            _globalOptLevel = 1;
+        else if (numberFlag(flag, "-O", limit) && limit <= 9)
+            _globalOptLevel = static_cast<int>(limit);
+        else
         {
-            token.print();
+            cerr << "Unknown flag: " << flag << endl;
+            return 1;
         }
-        return 0;
     }
 
-    Parser parser(tokens);
-    auto cstRoot = parser.parse();
-
-    if (option == "cst")
+    if (serve)
     {
-        OutPutGenerator CSToutput;
-        CSToutput.PrintCST(cstRoot);
-        return 0;
+        Server server(fusedLexer, cacheDirectory);
+        if (first == "--serve")
+            return server.serveStream(0, 1);
+        return server.serveSocket(first.substr(8));
     }
 
-    SymbolTablesLinkedList tables(cstRoot);
-    auto symTableRoot = tables.parse();
-
-    ASTParser astParser(cstRoot);
-    auto astRoot = astParser.parse();
+    string filename = argv[1];
+    string option = argv[2];
 
-    if (option == "symbolTable")
-    {
+    fileAsArray fileArray(filename);
+    fileArray.readFile();
 
-        OutPutGenerator STOutput;
-        STOutput.PrintSymbolTables(symTableRoot);
-        return 0;
-    }
+    // the file is an image written by compile, mapped rather than read
+    if (option == "exec-image")
+        return execImage(fileArray.getSource());
 
-    if (option == "ast")
+    if (option == "compile")
     {
-        OutPutGenerator ASOutput;
-        ASOutput.PrintAST(astRoot);
-        return 0;
+        if (imagePath.empty())
+            imagePath = filename + ".img";
+        auto kind = bytecodeImage ? ProgramImage::Kind::Bytecode
+                                  : ProgramImage::Kind::Tree;
+        return compileProgram(fileArray, kind, fusedLexer,
+                              [&](const string &image)
+                              {
+                                  ofstream output(imagePath, ios::binary);
+                                  output.write(image.data(), image.size());
+                                  if (!output)
+                                      _globalErrorHandler.handle(26, 0,
+                                                                 imagePath);
+                              });
     }
 
-    if (option == "run")
+    if (!cacheDirectory.empty())
     {
-        Interpreter interpret(astRoot, symTableRoot);
+        CompileCache cache(cacheDirectory);
+        return runCached(fileArray, option, fusedLexer, cache);
     }
-
-    return 0;
+    return runProgram(fileArray, option, fusedLexer);
 }
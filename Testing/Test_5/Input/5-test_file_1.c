@@ -0,0 +1,66 @@
+// ***************************************************
+// * Test Program 5 *
+// ***************************************************
+
+// Recursion: every call gets its own copy of the locals, and functions
+// may reuse each other's local names. Globals can't be shadowed, a local
+// with a global's name is error 29.
+int count;
+int answer;
+
+function int factorial (int n)
+{
+  int m;
+  int result;
+
+  if (n <= 1)
+  {
+    return 1;
+  }
+  m = n - 1;
+  result = factorial (m);
+  result = n * result;
+  return result;
+}
+
+function int is_even (int n)
+{
+  int m;
+  int result;
+
+  if (n == 0)
+  {
+    return 1;
+  }
+  m = n - 1;
+  result = is_odd (m);
+  return result;
+}
+
+function int is_odd (int n)
+{
+  int m;
+  int result;
+
+  if (n == 0)
+  {
+    return 0;
+  }
+  m = n - 1;
+  result = is_even (m);
+  return result;
+}
+
+procedure main (void)
+{
+  count = 10;
+  answer = factorial (count);
+  printf ("10! = %d\n", answer);
+
+  count = 7;
+  answer = is_even (count);
+  printf ("is_even(7) = %d\n", answer);
+  answer = is_odd (count);
+  printf ("is_odd(7) = %d\n", answer);
+  printf ("count after the calls = %d\n", count);
+}
@@ -0,0 +1,24 @@
+// ***************************************************
+// * Test Program 6 *
+// ***************************************************
+
+// ^ raises to a power. It binds tighter than * and groups to the right,
+// so 2 ^ 3 ^ 2 is 2 ^ 9.
+procedure main (void)
+{
+  int y;
+  int result;
+
+  result = 2 ^ 3 ^ 2;
+  printf ("2 ^ 3 ^ 2 = %d\n", result);
+
+  y = 3;
+  result = 2 ^ y + 1;
+  printf ("2 ^ y + 1 = %d\n", result);
+
+  result = 3 * 2 ^ 2;
+  printf ("3 * 2 ^ 2 = %d\n", result);
+
+  result = (2 ^ 3) ^ 2;
+  printf ("(2 ^ 3) ^ 2 = %d\n", result);
+}
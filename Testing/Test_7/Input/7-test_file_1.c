@@ -0,0 +1,54 @@
+// ***************************************************
+// * Test Program 7 *
+// ***************************************************
+
+// Code -O2 removes: statements after a return, if and while statements
+// whose condition is constant, and functions and globals that nothing
+// reaches from main. The output must not change.
+int total;
+int unused_global;
+
+function int never_called (int a)
+{
+  int b;
+  b = a * 2;
+  return b;
+}
+
+function int triple (int v)
+{
+  int t;
+  t = v * 3;
+  return t;
+  t = 0;
+  total = total + 100;
+}
+
+procedure main (void)
+{
+  int x;
+
+  total = 1;
+  x = triple (4);
+  printf ("triple(4) = %d\n", x);
+
+  if ((2 * 3) == 6)
+  {
+    total = total + 10;
+  }
+  else
+  {
+    total = total + 1000;
+  }
+  if (1 > 2)
+  {
+    total = total + 1000;
+  }
+  while (0 == 1)
+  {
+    total = total + 1000;
+  }
+  printf ("total = %d\n", total);
+  return 0;
+  printf ("after return\n");
+}